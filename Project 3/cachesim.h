@@ -0,0 +1,125 @@
+/* @file cachesim.h
+ * @brief Embeddable interface to the cache simulator. Every handle owns an independent cache, so one process
+ *        can drive any number of caches directly, without the command line, a trace, or shared state.
+ *        Build proj3_sweatt.c with -DCACHESIM_LIBRARY to leave out its main.
+ * @author Julian L. Sweatt
+ */
+#ifndef CACHESIM_H
+#define CACHESIM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*----------------------------------*
+ *              HEADER              *
+ *----------------------------------*/
+/**
+ * @struct CacheSim
+ * @brief Opaque handle to a simulated cache.
+ */
+typedef struct CacheSim CacheSim;
+
+/**
+ * @struct CacheSimConfig
+ * @brief Shape and policies of a simulated cache. Zeroed optional fields select the defaults.
+ */
+typedef struct
+{
+    unsigned int blockSize;      // Bytes per block, a power of two
+    unsigned int numSets;        // Number of sets, a power of two
+    unsigned int associativity;  // Ways per set
+    char writePolicy;            // T, B, A, or N as on the command line (0 selects B)
+    const char* replacement;     // Replacement policy identifier, e.g. "srrip" (NULL selects lru)
+    const char* prefetcher;      // Prefetcher identifier, e.g. "stride" (NULL disables prefetching)
+    char victimKind;             // (v)ictim or (m)iss cache beside the sets (0 attaches none)
+    unsigned int victimEntries;  // Number of blocks in the victim or miss cache
+    int classify;                // Nonzero breaks the misses down into compulsory, capacity, and conflict
+    unsigned int addressBits;    // Width of the addresses, up to 64 (0 selects 32), higher bits are dropped
+    const char* indexing;        // Set index function, "xor", "prime", or "skew" (NULL selects modulo), skew needing lru
+} CacheSimConfig;
+
+/**
+ * @struct CacheSimStats
+ * @brief Counters of a simulated cache since it was created or last reset.
+ */
+typedef struct
+{
+    unsigned long references;    // Accesses, of any operation
+    unsigned long hits;
+    unsigned long misses;
+    unsigned long memoryReferences; // Fetches, writebacks, and words written through
+    unsigned long fetches;       // Blocks read from memory, prefetches included
+    unsigned long writebacks;    // Dirty blocks written back on eviction
+    unsigned long prefetches;    // Blocks filled by the prefetcher
+    unsigned long usefulPrefetches; // Prefetched blocks demanded before eviction
+    unsigned long victimHits;    // Misses served by the victim or miss cache
+    unsigned long compulsory;    // Misses on blocks never fetched before (when classifying)
+    unsigned long capacity;      // Misses a fully associative cache also takes (when classifying)
+    unsigned long conflict;      // Remaining misses (when classifying)
+} CacheSimStats;
+
+/**
+ * @brief Create an empty cache.
+ * @param const CacheSimConfig* config Shape and policies of the cache.
+ * @return CacheSim* The new cache, NULL if the configuration is invalid.
+ */
+CacheSim* cachesimCreate(const CacheSimConfig* config);
+
+/**
+ * @brief Destroy a cache.
+ * @param CacheSim* sim Cache to destroy.
+ * @return void
+ */
+void cachesimDestroy(CacheSim* sim);
+
+/**
+ * @brief Access the cache once.
+ * @param CacheSim* sim Cache to access.
+ * @param uint64_t address Byte address.
+ * @param char operation 'R' to read or 'W' to write (anything else only probes).
+ * @return int 1 on a hit, 0 on a miss.
+ */
+int cachesimAccess(CacheSim* sim, uint64_t address, char operation);
+
+/**
+ * @brief Access the cache with a batch of references, in order.
+ * @param CacheSim* sim Cache to access.
+ * @param const uint64_t* addresses Byte address of each reference.
+ * @param const char* operations Operation of each reference, as for cachesimAccess (NULL reads every address).
+ * @param size_t count Number of references.
+ * @return void
+ */
+void cachesimAccessMany(CacheSim* sim, const uint64_t* addresses, const char* operations, size_t count);
+
+/**
+ * @brief Read the cache's counters.
+ * @param const CacheSim* sim Cache to read.
+ * @param CacheSimStats* stats Destination of the counters.
+ * @return void
+ */
+void cachesimStats(const CacheSim* sim, CacheSimStats* stats);
+
+/**
+ * @brief Empty the cache and zero its counters, keeping its configuration.
+ * @param CacheSim* sim Cache to reset.
+ * @return void
+ */
+void cachesimReset(CacheSim* sim);
+
+/**
+ * @brief Save the cache's full state and counters to a checkpoint.
+ * @param CacheSim* sim Cache to save.
+ * @param const char* path Path of the checkpoint to write.
+ * @return int 1 on success, 0 on failure.
+ */
+int cachesimSave(CacheSim* sim, const char* path);
+
+/**
+ * @brief Restore the cache's full state and counters from a checkpoint of an identically configured cache.
+ * @param CacheSim* sim Cache to restore into.
+ * @param const char* path Path of the checkpoint to read.
+ * @return int 1 on success, 0 if the checkpoint is unreadable or does not match the cache (which is then left empty).
+ */
+int cachesimRestore(CacheSim* sim, const char* path);
+
+#endif
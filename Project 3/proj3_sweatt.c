@@ -6,15 +6,97 @@
 /*----------------------------------*
  *             IMPORTS              *
  *----------------------------------*/
+// Declare the POSIX APIs (Barriers, Monotonic Clocks, mmap Advice) Outside GNU Mode Too
+#define _POSIX_C_SOURCE 200809L
+#define _DEFAULT_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
 #include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+#include "cachesim.h"
 
 /*----------------------------------*
  *             CONFIG               *
  *----------------------------------*/
 #define DEBUG_MODE 0
+// Library Builds Keep Everything but the cachesim API Internal, Leaving No Other Symbol to Collide With the Embedder's
+#if defined(CACHESIM_LIBRARY)
+#define INTERNAL static __attribute__((unused))
+#define INTERNAL_DECLARATION static __attribute__((unused))
+#else
+#define INTERNAL
+#define INTERNAL_DECLARATION extern
+#endif
 #define MAX_LINES 100
+#define TRACE_CHUNK_SIZE (1 << 20)
+#define TRACE_BATCH_SIZE 4096
+#define PIPELINE_SLOTS 8
+#define KERNEL_BLOCK_SIZES 3
+#define KERNEL_ASSOCIATIVITIES 5
+#define BINARY_TRACE_MAGIC "C3BT"
+#define BINARY_TRACE_VERSION 1
+#define BINARY_TRACE_CORES_VERSION 2
+#define BINARY_TRACE_WIDE_VERSION 3
+#define BINARY_BLOCK_CORES 0x80000000u
+#define BINARY_BLOCK_WIDE 0x40000000u
+#define BINARY_TRACE_HEADER_SIZE 28
+#define BINARY_BLOCK_HEADER_SIZE 8
+#define MAX_POLICIES 4
+#define MAX_REPLACEMENT_POLICIES 7
+#define MAX_INDEX_FUNCTIONS 4
+#define SKEW_MULTIPLIER 0x9E3779B97F4A7C15ull
+#define NO_WAY 0xFFFF
+#define BRRIP_LONG_INTERVAL 32
+#define MAX_PREFETCHERS 3
+#define MAX_PREFETCH_DEGREE 4
+#define STRIDE_DEGREE 2
+#define STRIDE_STREAMS 16
+#define STRIDE_WINDOW 16
+#define DELTA_HISTORY 32
+#define MAX_VICTIM_ENTRIES 64
+#define NO_BLOCK 0xFFFFFFFFu
+#define NO_ADDRESS UINT64_MAX
+#define MAX_SEEDS 16
+#define MAX_THREADS 256
+#define SHARD_CHUNK_SIZE (1 << 16)
+#define MAX_SWEEP_VALUES 64
+#define BENCH_REPEATS 3
+#define BENCH_TOLERANCE 0.10
+#define WORKLOAD_BLOCK_SIZE 64
+#define WORKLOAD_SETS 1024
+#define WORKLOAD_ASSOCIATIVITY 8
+#define WORKLOAD_GRAIN 64
+#define WORKLOAD_SCATTER 2654435761u
+#define MAX_LEVELS 8
+#define MAX_CORES 1024
+#define WORD_BYTES 4
+#define DRAM_QUEUE_DEPTH 32
+#define MAX_DRAM_QUEUE_DEPTH 1024
+#define DRAM_GAP 4
+#define DRAM_CAS 14
+#define DRAM_RCD 14
+#define DRAM_RP 14
+#define DRAM_BURST 4
+#define NO_ROW UINT64_MAX
+#define CHECKPOINT_MAGIC "C3CK"
+#define CHECKPOINT_VERSION 2
+#define CHECKPOINT_BYTE_ORDER 0x01020304u
+#define CHECKPOINT_HEADER_SIZE 16
+#define CHECKPOINT_CONFIG_SIZE 24
+#define CHECKPOINT_CACHE_SIZE 100
+#define CHECKPOINT_COUNTERS 9
 
 /*----------------------------------*
  *              HEADER              *
@@ -27,7 +109,8 @@
 typedef struct
 {
     char operation;              // Indicates (R)ead or (W)rite Operation
-    unsigned int address;        // Address to Cache
+    unsigned short core;         // Core Issuing the Operation (0 in Single Core Traces)
+    uint64_t address;            // Address to Cache
 } Line;
 
 /**
@@ -38,599 +121,6659 @@ typedef struct
 {
     Line * lines;
     unsigned int size;
+    unsigned int capacity;
 } LineList;
 
 /**
- * @struct Block
- * @brief Block within a set;
+ * @struct TraceReader
+ * @brief Chunked reader over a trace, backed by either a stream buffer or a memory mapped file.
  */
 typedef struct
 {
-    int address;
-    char dirty;
-    int lastused;
-} Block;
+    FILE* stream;                // Source stream (NULL when memory mapped)
+    char* buffer;                // Chunk buffer or mapped file contents
+    size_t length;               // Number of valid bytes in the buffer
+    size_t position;             // Parse position within the buffer
+    char mapped;                 // Indicates the buffer is a memory mapping
+    char eof;                    // Indicates the stream has been fully read into the buffer
+    char binary;                 // Indicates the trace is in the binary format
+    char blockCores;             // Indicates the current binary block's records carry core IDs
+    char blockWide;              // Indicates the current binary block's addresses wrap at 64 bits rather than 32
+    unsigned int blockRemaining; // Records left to decode in the current binary block
+    uint64_t blockAddress;       // Last address decoded in the current binary block
+    uint64_t addressMask;        // Low bits kept of every address, the option's address width
+    size_t blockEnd;             // Buffer offset where the current binary block ends
+} TraceReader;
 
 /**
- * @struct Set
- * @brief Set within a cache;
+ * @struct Timing
+ * @brief Latencies of a cache (or hierarchy level) in cycles, from which its time is estimated.
  */
 typedef struct
 {
-    Block * blocks;
-} Set;
+    double hitLatency;           // Cycles of every reference to the cache
+    double missPenalty;          // Further cycles of every block fetched from memory (or the level below)
+    double writebackCost;        // Further cycles of every block written back or word written through
+} Timing;
 
 /**
- * @struct Cache
- * @brief General purpose cache.
+ * @struct DramConfig
+ * @brief Organization of the DRAM behind a cache, and the pace the cache's references reach it at.
+ */
+typedef struct
+{
+    unsigned int banks;          // Banks, each with one row buffer (0 models no DRAM)
+    unsigned int rowBytes;       // Bytes per row, consecutive rows interleaved across the banks
+    char page;                   // Row buffer policy, (o)pen page or (c)losed page
+    unsigned int depth;          // Requests the controller's queue holds
+    unsigned int gap;            // Cycles between the cache's references, spacing the arrival of its requests
+} DramConfig;
+
+/**
+ * @struct Options
+ * @brief Command line options.
+ */
+typedef struct
+{
+    const char* tracePath;       // Trace file to memory map (NULL streams stdin)
+    const char* convertPath;     // Binary trace to write instead of simulating (NULL simulates)
+    const char* policies;        // Write policy identifiers to simulate, in report order
+    unsigned int curveSets;      // Largest set count of the miss-ratio curve (0 simulates normally)
+    unsigned int curveWays;      // Largest associativity of the miss-ratio curve
+    unsigned int threads;        // Worker threads, each simulating a range of sets (or sweep configurations)
+    const char* sweep;           // Configuration sweep, blockSizes:sets:associativities (NULL simulates normally)
+    char format;                 // Sweep table format, (c)sv or (j)son
+    const struct ReplacementPolicy* replacement; // Replacement policy of every cache
+    const char* levels[MAX_LEVELS]; // Hierarchy level specifications, nearest the processor first
+    int levelCount;              // Number of hierarchy levels (0 simulates a single cache)
+    const struct Prefetcher* prefetcher; // Prefetcher of every cache (NULL disables prefetching)
+    char victimKind;             // Buffer attached to every cache, (v)ictim or (m)iss cache (0 attaches none)
+    unsigned int victimEntries;  // Number of blocks in the attached buffer
+    char classify;               // Indicates every cache breaks its misses down into compulsory, capacity and conflict
+    unsigned long interval;      // References per interval of the time series (0 logs nothing)
+    unsigned long warmup;        // Leading intervals left out of the reports
+    const char* intervalPath;    // CSV file of the time series (NULL writes it to stdout)
+    unsigned int sampleShift;    // Spatial sampling keeps 2^-sampleShift of the blocks (0 simulates every reference)
+    unsigned int seeds;          // Independent samples, each with its own hash seed
+    char protocol;               // Coherence protocol of the private caches, (m)esi or m(o)esi (0 simulates one cache)
+    unsigned int cores;          // Number of cores, each with a private cache
+    Timing timings[MAX_LEVELS];  // Latencies of the cache, or of each hierarchy level nearest the processor first
+    int timingCount;             // Number of latencies given (0 reports no timing)
+    double bandwidth;            // Memory bus bytes per cycle (0 leaves the bus unlimited)
+    const char* savePath;        // Checkpoint to save the caches to after simulating (NULL saves none)
+    const char* restorePath;     // Checkpoint to restore the caches from before simulating (NULL starts cold)
+    char clearRestored;          // Indicates the restored counters are zeroed, keeping only the warmed contents
+    unsigned int addressBits;    // Width of the trace's addresses, split into the tag, index and offset bits
+    const char* workload;        // Synthetic trace to generate instead of simulating (NULL simulates)
+    const char* benchmark;       // Configurations to time, as a sweep (NULL simulates normally)
+    const char* baselinePath;    // Benchmark CSV to flag throughput regressions against (NULL compares nothing)
+    double tolerance;            // Slowdown from the baseline allowed before a configuration is flagged
+    char collapseRuns;           // Indicates runs of references to one block are simulated at once
+    const struct IndexFunction* indexing; // Set index function of every cache
+    DramConfig dram;             // DRAM behind every cache (0 banks counts memory references uniformly)
+} Options;
+
+/**
+ * @struct Geometry
+ * @brief Shape of a cache and the bitwise breakdown of its addresses.
+ */
+typedef struct
+{
+    unsigned int blockSize;
+    unsigned int numSets;
+    unsigned int associativity;
+    unsigned int addressBits;
+    unsigned int offsetBits;
+    unsigned int indexBits;
+    unsigned int tagBits;
+    char indexing;               // Set index function, (x)or folded, (p)rime modulo or (s)kewed per way (0 is modulo)
+    unsigned int modulus;        // Sets indexed, the largest prime up to the set count under prime modulo indexing
+} Geometry;
+
+/**
+ * @struct IndexFunction
+ * @brief Mapping of block addresses to sets.
+ */
+typedef struct IndexFunction
+{
+    char id;                     // Geometry identifier (0 is plain modulo)
+    const char* name;            // Command line identifier
+    const char* title;           // Report name
+} IndexFunction;
+
+/**
+ * @struct WritePolicy
+ * @brief Write hit and write miss handling of a cache.
+ */
+typedef struct
+{
+    char id;                     // Command line identifier
+    char writeBack;              // Write hits mark the block dirty instead of writing through to memory
+    char writeAllocate;          // Write misses fill the block into the cache
+    const char* name;            // Report heading
+} WritePolicy;
+
+/**
+ * @struct ReplacementPolicy
+ * @brief Victim selection of a cache. Each policy keeps its metadata packed in a fixed number of bytes per set.
+ */
+typedef struct ReplacementPolicy
+{
+    const char* name;            // Command line identifier
+    const char* title;           // Report name
+    char powerOfTwo;             // Indicates the policy requires a power of two associativity
+    unsigned int (*stateBytes)(unsigned int associativity);
+    void (*init)(unsigned char* state, unsigned int associativity, unsigned int index);
+    void (*touch)(unsigned char* state, unsigned int associativity, unsigned int way);
+    void (*fill)(unsigned char* state, unsigned int associativity, unsigned int way);
+    unsigned int (*victim)(unsigned char* state, unsigned int associativity);
+} ReplacementPolicy;
+
+/**
+ * @struct Prefetcher
+ * @brief Hardware prefetcher of a cache, trained on the demand block stream with its state in a fixed number of bytes.
+ */
+typedef struct Prefetcher
+{
+    const char* name;            // Command line identifier
+    const char* title;           // Report name
+    unsigned int stateBytes;     // Size of the prefetcher's state, zeroed to start
+    unsigned int (*predict)(unsigned char* state, uint64_t block, int miss, uint64_t* blocks);
+} Prefetcher;
+
+/**
+ * @struct Stream
+ * @brief Stride prefetcher entry following one stream of block addresses.
+ */
+typedef struct
+{
+    uint64_t last;               // Last block of the stream
+    int stride;                  // Last difference between consecutive blocks
+    unsigned int confidence;     // Consecutive repeats of the stride, saturating at 3
+    unsigned long used;          // Access count when the stream was last used (0 when empty)
+} Stream;
+
+/**
+ * @struct StrideState
+ * @brief Stride prefetcher state, a table of streams replaced least recently used first.
+ */
+typedef struct
+{
+    Stream streams[STRIDE_STREAMS];
+    unsigned long clock;         // Number of accesses seen
+} StrideState;
+
+/**
+ * @struct DeltaState
+ * @brief Delta correlation prefetcher state, the recent differences between missed blocks.
+ */
+typedef struct
+{
+    uint64_t last;               // Last missed block
+    unsigned long count;         // Number of misses seen
+    int deltas[DELTA_HISTORY];   // Ring of deltas, the delta ending miss n is at n % DELTA_HISTORY
+} DeltaState;
+
+/**
+ * @struct VictimCache
+ * @brief Small fully associative LRU buffer beside a cache, probed on misses before memory. A victim cache
+ *        holds the blocks the cache evicts (written back as they enter), a miss cache holds copies of the
+ *        blocks the cache fetches. Either way a buffer hit saves exactly one fetch.
+ */
+typedef struct
+{
+    char kind;                   // (v)ictim or (m)iss cache
+    unsigned int entries;        // Number of blocks held
+    uint64_t* blocks;            // Block address of each entry
+    unsigned long* used;         // Access clock when each entry was last used (0 when empty)
+    unsigned long clock;         // Number of buffer accesses
+    unsigned long hits;          // Misses served by the buffer instead of memory
+} VictimCache;
+
+/**
+ * @struct DramRequest
+ * @brief Memory reference waiting in the DRAM controller's queue.
+ */
+typedef struct
+{
+    unsigned int bank;           // Bank holding the address
+    uint64_t row;                // Row of the address within its bank
+    unsigned long arrival;       // Cycle the request reached the controller
+    char write;                  // Indicates a writeback or written through word rather than a fetch
+} DramRequest;
+
+/**
+ * @struct Dram
+ * @brief Banked DRAM behind a cache, its controller scheduling the queued requests first ready, first come
+ *        first served: of the requests whose banks free up first, row buffer hits go ahead of older misses.
+ */
+typedef struct
+{
+    DramConfig config;
+    uint64_t* openRows;          // Row held in each bank's row buffer (NO_ROW when precharged)
+    unsigned long* readyAt;      // Cycle each bank can start its next access
+    DramRequest* queue;          // Waiting requests, oldest first
+    unsigned int size;           // Number of waiting requests
+    unsigned long clock;         // Cycle after the controller's last command
+    unsigned long busFree;       // Cycle the data bus finishes its last burst
+    unsigned long elapsed;       // References of the cache before its counters were last cleared, keeping arrivals in order
+    unsigned long delay;         // Cycles the cache has stalled on a full queue, delaying its later requests
+    unsigned long stalls;        // Cycles stalled on a full queue since the counters were cleared
+    unsigned long requests;      // Requests served
+    unsigned long writes;        // Writebacks and written through words served
+    unsigned long rowHits;       // Requests finding their row open
+    unsigned long rowMisses;     // Requests finding their bank precharged
+    unsigned long conflicts;     // Requests finding another row open, which must be closed first
+    unsigned long latency;       // Cycles from issue (stalls included) to the end of the data burst, over all requests
+} Dram;
+
+/**
+ * @struct Classifier
+ * @brief Three-C miss classification beside a cache: a fully associative LRU shadow of equal capacity and the
+ *        set of blocks ever fetched. Misses on new blocks are compulsory, misses the shadow also takes are
+ *        capacity misses, and the rest are conflict misses.
+ */
+typedef struct
+{
+    unsigned int capacity;       // Blocks held by the shadow, numSets x associativity
+    unsigned int size;           // Blocks currently held by the shadow
+    uint64_t* blocks;            // Block address of each shadow node
+    unsigned int* prev;          // Previous (more recent) node of each node, NO_BLOCK at the head
+    unsigned int* next;          // Next (less recent) node of each node, NO_BLOCK at the tail
+    unsigned int head;           // Most recently used node
+    unsigned int tail;           // Least recently used node
+    unsigned int* nodes;         // Open addressed map from block address to node, NO_BLOCK when empty
+    unsigned int nodeMask;       // Map slots minus one, a power of two
+    uint64_t* seen;              // Open addressed set of block addresses ever fetched, NO_ADDRESS when empty
+    unsigned int seenMask;       // Set slots minus one, a power of two
+    unsigned int seenCount;      // Blocks in the set
+    unsigned long* counts;       // Compulsory, capacity and conflict misses of each set, numSets x 3
+} Classifier;
+
+/**
+ * @struct IntervalLog
+ * @brief Time series of a cache's counters, written as a CSV row every interval of references. The leading
+ *        warmup intervals are left out of the cache's totals, so its report covers the steady state.
  */
 typedef struct
 {
-    Set* sets;
-    unsigned int hits;
-    unsigned int misses;
-    unsigned int memrefs;
-    unsigned int cacheReferences;
+    unsigned long length;        // References per interval
+    unsigned long warmup;        // Leading intervals left out of the cache's totals
+    FILE* out;                   // Destination of the rows, shared by every cache of a run
+    unsigned long count;         // Intervals written
+    unsigned long references;    // Cache references at the start of the interval
+    unsigned long misses;        // Cache misses at the start of the interval
+    unsigned long writebacks;    // Cache writebacks at the start of the interval
+    unsigned long memrefs;       // Cache memory references at the start of the interval
+    uint64_t* blocks;            // Open addressed set of the blocks touched, live where stamped with the interval
+    unsigned int* stamps;        // Interval number (plus one) that last stamped each slot
+    unsigned int mask;           // Set slots minus one, a power of two
+    unsigned int unique;         // Blocks touched in the interval
+} IntervalLog;
+
+struct Cache;
+
+/**
+ * @brief Batch simulation loop of a cache, specialized for its geometry where possible.
+ */
+typedef void (*SimulationKernel)(struct Cache* cache, Line* lines, unsigned int count);
+
+/**
+ * @struct Cache
+ * @brief General purpose cache. The tag store is laid out per set as a contiguous array of tags, each only as
+ *        wide as the geometry's tag bits need, with the valid and dirty bits of the set's ways packed into
+ *        bitmasks and the replacement state alongside.
+ */
+typedef struct Cache
+{
+    Geometry geometry;
+    const WritePolicy* policy;
+    const ReplacementPolicy* replacement;
+    SimulationKernel kernel;     // Batch simulation loop for the geometry
+    unsigned int maskWords;      // Bitmask words per set, one bit per way
+    unsigned int stateBytes;     // Replacement state bytes per set
+    unsigned int tagBytes;       // Bytes per stored tag, the narrowest of 2, 4 or 8 holding the tag bits
+    void* tags;                  // Tag of each way, numSets x associativity
+    uint64_t* valid;             // Valid bit of each way, numSets x maskWords
+    uint64_t* dirty;             // Dirty bit of each way, numSets x maskWords
+    unsigned char* state;        // Replacement state, numSets x stateBytes
+    const Prefetcher* prefetcher; // Prefetcher filling the sets ahead of demand (NULL disables prefetching)
+    unsigned char* prefetchState; // Prefetcher state
+    uint64_t* prefetched;        // Ways filled by a prefetch and not yet demanded, numSets x maskWords
+    void* pollutedTags;          // Tags evicted by a prefetch into each way, numSets x associativity
+    uint64_t* polluted;          // Valid bit of each polluted tag, numSets x maskWords
+    unsigned long prefetches;    // Blocks filled by the prefetcher
+    unsigned long usefulPrefetches; // Prefetched blocks demanded before eviction
+    unsigned long pollution;     // Demand misses on blocks a prefetch evicted
+    VictimCache* victims;        // Victim or miss cache beside the sets (NULL attaches none)
+    Classifier* classifier;      // Three-C miss classification (NULL classifies nothing)
+    IntervalLog* intervals;      // Interval time series (NULL logs nothing)
+    Dram* dram;                  // DRAM the memory references go to (NULL counts them uniformly)
+    uint64_t lastBlock;          // Block the last reference left resident, hit again without a way scan (NO_ADDRESS when unknown)
+    unsigned int lastIndex;      // Set of the last block
+    int lastWay;                 // Way of the last block
+    unsigned long clock;         // Last stamp of a skewed cache, whose state is a least recently used stamp per way
+    unsigned long writebacks;    // Dirty blocks written back on eviction
+    unsigned long fetches;       // Blocks read from memory (or the level below), prefetches included
+    unsigned long hits;
+    unsigned long misses;
+    unsigned long memrefs;
+    unsigned long cacheReferences;
 } Cache;
 
+/**
+ * @struct CacheSim
+ * @brief Library handle, a cache configured on its own rather than from the options.
+ */
+struct CacheSim
+{
+    Cache* cache;
+    uint64_t addressMask;        // Low bits kept of every address, the configuration's address width
+};
+
+/**
+ * @struct System
+ * @brief Cores with private caches of one geometry, kept coherent by snooping. A block maps to the same set
+ *        in every core, so the coherence state of a set only changes with accesses to that set.
+ */
+typedef struct System
+{
+    Cache** cores;               // Private write-back cache of each core
+    unsigned int count;          // Number of cores
+    char protocol;               // (m)esi or m(o)esi
+    uint64_t* shared;            // Shared bit of each core's ways (S, or O when dirty), cores x numSets x maskWords
+    uint64_t* stale;             // Ways invalidated by another core's write, whose tags are kept to spot coherence misses
+    unsigned long* coherenceMisses; // Misses on blocks another core invalidated, per core
+    unsigned long invalidations; // Copies invalidated by writes
+    unsigned long interventions; // Misses supplied by another core's cache instead of memory
+    unsigned long upgrades;      // Write hits on shared blocks
+    unsigned long writebacks;    // Modified blocks written to memory
+    unsigned long ignored;       // References from cores beyond the system
+} System;
+
+/**
+ * @struct Shard
+ * @brief A worker's range of sets, with double buffered lines and private counters.
+ */
+typedef struct
+{
+    struct ShardPool* pool;      // Pool the shard belongs to
+    pthread_t thread;            // Worker simulating the shard
+    Line* lines[2];              // Double buffered lines that index into the shard's sets
+    unsigned int sizes[2];       // Number of lines in each buffer
+    Cache views[MAX_POLICIES];   // Views of the shared caches with thread local counters
+    System* system;              // View of the shared system with thread local counters (coherent mode)
+} Shard;
+
+/**
+ * @struct ShardPool
+ * @brief Worker threads that simulate disjoint set ranges of the same caches in lock step rounds.
+ */
+typedef struct ShardPool
+{
+    pthread_barrier_t barrier;   // Separates rounds, workers consume one buffer while the other is filled
+    Shard* shards;               // One shard per worker
+    unsigned int count;          // Number of shards
+    int policies;                // Number of caches viewed by each shard
+    const Geometry* geometry;    // Geometry the sets are partitioned by
+    char coherent;               // Indicates the shards simulate a system instead of independent caches
+    char last[2];                // Indicates a buffer was filled after the end of the trace
+} ShardPool;
+
+/**
+ * @struct LinePipeline
+ * @brief Bounded single producer, single consumer ring of line batches between a reader thread and the simulation.
+ *        Only the reader advances the tail and only the simulation advances the head, so neither takes a lock.
+ */
+typedef struct
+{
+    TraceReader* reader;         // Trace decoded by the reader thread
+    pthread_t thread;            // Reader thread
+    Line* batches;               // PIPELINE_SLOTS batches of TRACE_BATCH_SIZE lines
+    unsigned int sizes[PIPELINE_SLOTS]; // Number of lines in each batch, 0 marks the end of the trace
+    unsigned int* runs;          // Length and write count of each run of a batch's references to one block (NULL collapses nothing)
+    unsigned int runCounts[PIPELINE_SLOTS]; // Number of runs in each batch
+    unsigned int runShift;       // Offset bits dropped to compare blocks
+    atomic_ulong head;           // Batches consumed
+    atomic_ulong tail;           // Batches produced
+} LinePipeline;
+
+/**
+ * @struct SweepJob
+ * @brief One configuration of a sweep, simulated with every selected write policy.
+ */
+typedef struct
+{
+    Geometry geometry;
+    unsigned long hits[MAX_POLICIES];
+    unsigned long misses[MAX_POLICIES];
+    unsigned long memrefs[MAX_POLICIES];
+    double seconds[MAX_POLICIES]; // Fastest pass of each write policy (benchmarks only)
+} SweepJob;
+
+/**
+ * @struct Baseline
+ * @brief Stored throughput of one benchmarked configuration.
+ */
+typedef struct
+{
+    unsigned int blockSize;
+    unsigned int numSets;
+    unsigned int associativity;
+    char replacement[16];
+    char policy[64];
+    double rate;                 // References per second
+} Baseline;
+
+/**
+ * @struct Workload
+ * @brief Synthetic trace, generated reproducibly from its seed.
+ */
+typedef struct
+{
+    char kind;                   // (s)equential, s(t)rided, (r)andom, (z)ipfian, pointer (c)hase, or (m)ixed
+    unsigned long references;    // Lines to generate
+    uint64_t footprint;          // Bytes the addresses span
+    double writes;               // Share of the lines that write
+    uint64_t seed;               // Seed of the generator
+    unsigned int stride;         // Bytes between strided references
+    double alpha;                // Skew of the Zipfian block popularity
+} Workload;
+
+/**
+ * @struct WorkQueue
+ * @brief Per worker deque of job indices. The owner takes from the tail, thieves steal from the head.
+ */
+typedef struct
+{
+    pthread_mutex_t lock;
+    unsigned int* jobs;
+    unsigned int head;           // Next job to steal
+    unsigned int tail;           // One past the owner's next job
+} WorkQueue;
+
+/**
+ * @struct SweepPool
+ * @brief Work stealing thread pool running sweep jobs over the shared, read only list of lines.
+ */
+typedef struct SweepPool
+{
+    SweepJob* jobs;
+    WorkQueue* queues;           // One queue per worker
+    unsigned int workers;
+} SweepPool;
+
+/**
+ * @struct SweepWorker
+ * @brief A sweep pool thread and the queue it owns.
+ */
+typedef struct
+{
+    struct SweepPool* pool;
+    unsigned int id;
+    pthread_t thread;
+} SweepWorker;
+
+/**
+ * @struct StackDistance
+ * @brief LRU stack distance (Mattson) engine for a single set count, covering every associativity up to a depth.
+ */
+typedef struct
+{
+    unsigned int indexBits;      // Number of sets is 2^indexBits
+    unsigned int depth;          // Largest associativity tracked
+    uint64_t* stacks;            // Per set LRU stacks of block addresses, most recent first
+    unsigned int* sizes;         // Number of blocks in each set's stack
+    unsigned long* histogram;    // References found at each stack distance, [0, depth)
+    unsigned long references;    // References recorded
+    unsigned int seed;           // Hash seed of the engine's sample
+    unsigned int sampleShift;    // Engine records 2^-sampleShift of the blocks (0 records every reference)
+} StackDistance;
+
+/**
+ * @struct Level
+ * @brief One level of a cache hierarchy. Its cache's memory references count the requests sent to the level below.
+ */
+typedef struct
+{
+    Cache* cache;
+    char inclusion;              // (i)nclusive of, (e)xclusive of, or (n)on-inclusive of the levels above
+    unsigned long writebacks;    // Dirty blocks evicted to the level below
+    unsigned long invalidations; // Blocks back-invalidated in the levels above to keep them included
+} Level;
+
+/**
+ * @struct Hierarchy
+ * @brief Chain of cache levels in front of memory, where each level's misses and evictions access the next.
+ */
+typedef struct
+{
+    Level levels[MAX_LEVELS];    // Levels nearest the processor first
+    int count;
+    unsigned long memoryReads;   // Blocks read from memory
+    unsigned long memoryWrites;  // Writes and writebacks reaching memory
+} Hierarchy;
+
 // ---- Dynamic Input Functions --- //
 /**
  * @brief Initialize a dynamic list of lines.
  * @return void
  */
-void initLines(void);
+INTERNAL void initLines(void);
 
 /**
  * @brief Deinitialize a dynamic list of lines.
  * @return void
  */
-void deinitLines(void);
+INTERNAL void deinitLines(void);
+
+/**
+ * @brief Append the rest of a trace to the list of lines.
+ * @param TraceReader* reader Reader positioned after the trace header.
+ * @return void
+ */
+INTERNAL void loadLines(TraceReader* reader);
 
 /**
- * @brief Append a line to a list of lines dynamically.
+ * @brief Append a line to a list of lines dynamically. Capacity grows geometrically.
  * @param char operation Indicates (R)ead or (W)rite Operation.
- * @param int address Address portion of line.
+ * @param uint64_t address Address portion of line.
  * @return void
  */
-void addLine(char operation, int address);
+INTERNAL void addLine(char operation, uint64_t address);
 
 /**
  * @brief Print the list of lines to stdout.
  * @return void
  * @private This is a debug function.
  */
-void printLines(void);
+INTERNAL void printLines(void);
 
 /**
  * @brief Print block size, number of sets, associativity, and list of lines from input.
  * @return void
  * @private This is a debug function.
  */
-void printInput(void);
+INTERNAL void printInput(void);
+
+// ------- Trace Ingestion -------- //
+/**
+ * @brief Open a trace for chunked reading. Files are memory mapped when possible.
+ * @param const char* path Path of the trace file, or NULL to stream stdin.
+ * @return TraceReader* Reader positioned at the start of the trace, NULL on failure.
+ */
+INTERNAL TraceReader* openTraceReader(const char* path);
+
+/**
+ * @brief Close a trace reader and release its buffer or mapping.
+ * @param TraceReader* reader Reader to close.
+ * @return void
+ */
+INTERNAL void closeTraceReader(TraceReader* reader);
+
+/**
+ * @brief Read the next unsigned integer from the trace, skipping leading whitespace.
+ * @param TraceReader* reader Reader to parse from.
+ * @param unsigned int* value Destination of the parsed integer.
+ * @return int 1 if a value was read, 0 at the end of the trace.
+ */
+INTERNAL int readTraceInteger(TraceReader* reader, unsigned int* value);
+
+/**
+ * @brief Read the next W/R address line from the trace.
+ * @param TraceReader* reader Reader to parse from.
+ * @param Line* l Destination of the parsed line.
+ * @return int 1 if a line was read, 0 at the end of the trace.
+ */
+INTERNAL int readTraceLine(TraceReader* reader, Line* l);
+
+/**
+ * @brief Read up to a batch of W/R address lines from the trace. Binary traces decode a block at a time.
+ * @param TraceReader* reader Reader to parse from.
+ * @param Line* lines Destination of the parsed lines.
+ * @param unsigned int max Maximum number of lines to read.
+ * @return unsigned int Number of lines read, 0 at the end of the trace.
+ */
+INTERNAL unsigned int readTraceBatch(TraceReader* reader, Line* lines, unsigned int max);
+
+/**
+ * @brief Read the block size, number of sets, and associativity from the start of the trace.
+ * @param TraceReader* reader Reader to parse from.
+ * @return int 1 if the header was read, 0 if the trace is malformed.
+ */
+INTERNAL int readTraceHeader(TraceReader* reader);
+
+/**
+ * @brief Convert a trace to the binary format. Records hold a packed op bit and a zigzag
+ *        varint address delta, grouped in independently decodable blocks.
+ * @param TraceReader* reader Reader positioned after the trace header.
+ * @param const char* path Path of the binary trace to write.
+ * @return int 1 on success, 0 on failure.
+ */
+INTERNAL int convertTrace(TraceReader* reader, const char* path);
 
 // -------- Cache Functions ------- //
 /**
  * @brief Initialize a set associative cache.
+ * @param const Geometry* geometry Shape of the cache, with its address bits calculated.
+ * @param const WritePolicy* policy Write policy of the cache.
+ * @param const ReplacementPolicy* replacement Replacement policy of the cache.
+ * @return Cache* The new cache.
+ */
+INTERNAL Cache* initCache(const Geometry* geometry, const WritePolicy* policy, const ReplacementPolicy* replacement);
+
+/**
+ * @brief Attach a prefetcher to a cache, giving it fresh state.
+ * @param Cache* cache Cache to prefetch into.
+ * @param const Prefetcher* prefetcher Prefetcher to attach.
  * @return void
  */
-void initCache(void);
+INTERNAL void setPrefetcher(Cache* cache, const Prefetcher* prefetcher);
 
 /**
- * @brief Deinitialize the set associative cache.
+ * @brief Attach an empty victim or miss cache to a cache.
+ * @param Cache* cache Cache to attach to.
+ * @param char kind (v)ictim or (m)iss cache.
+ * @param unsigned int entries Number of blocks the buffer holds.
  * @return void
  */
-void deinitCache(void);
+INTERNAL void setVictimCache(Cache* cache, char kind, unsigned int entries);
 
 /**
- * @brief Reset the set associative cache's contents.
+ * @brief Attach a three-C miss classifier to a cache.
+ * @param Cache* cache Cache to classify the misses of.
  * @return void
  */
-void resetCache(void);
+INTERNAL void setClassifier(Cache* cache);
 
 /**
- * @brief Calculate bitwise breakdown of the address.
+ * @brief Attach an interval time series to a cache.
+ * @param Cache* cache Cache to log the counters of.
+ * @param unsigned long length References per interval.
+ * @param unsigned long warmup Leading intervals left out of the cache's totals.
+ * @param FILE* out Destination of the CSV rows.
+ * @return void
+ */
+INTERNAL void setIntervalLog(Cache* cache, unsigned long length, unsigned long warmup, FILE* out);
+
+/**
+ * @brief Write the row of a cache's last interval, complete or not.
+ * @param Cache* cache Cache with an interval time series attached.
+ * @return void
+ */
+INTERNAL void flushIntervalLog(Cache* cache);
+
+/**
+ * @brief Attach an idle DRAM to a cache, which then sends it every memory reference.
+ * @param Cache* cache Cache to attach to.
+ * @param const DramConfig* config Organization of the DRAM.
+ * @return void
+ */
+INTERNAL void setDram(Cache* cache, const DramConfig* config);
+
+/**
+ * @brief Serve every request still waiting in a DRAM's queue.
+ * @param Dram* dram DRAM to drain.
+ * @return void
+ */
+INTERNAL void drainDram(Dram* dram);
+
+/**
+ * @brief Look up a prefetcher by its command line identifier.
+ * @param const char* name Identifier of the prefetcher.
+ * @return const Prefetcher* The prefetcher, NULL if the identifier is unknown.
+ */
+INTERNAL const Prefetcher* findPrefetcher(const char* name);
+
+/**
+ * @brief Look up a replacement policy by its command line identifier.
+ * @param const char* name Identifier of the policy.
+ * @return const ReplacementPolicy* The policy, NULL if the identifier is unknown.
+ */
+INTERNAL const ReplacementPolicy* findReplacementPolicy(const char* name);
+
+/**
+ * @brief Look up a set index function by its command line identifier.
+ * @param const char* name Identifier of the index function.
+ * @return const IndexFunction* The index function, NULL if the identifier is unknown.
+ */
+INTERNAL const IndexFunction* findIndexFunction(const char* name);
+
+/**
+ * @brief Check whether a replacement policy can manage a cache's sets.
+ * @param const Geometry* geometry Shape of the cache.
+ * @param const ReplacementPolicy* replacement Replacement policy to check.
+ * @return int 1 if the policy supports the geometry's associativity, 0 otherwise.
+ */
+INTERNAL int supportsReplacement(const Geometry* geometry, const ReplacementPolicy* replacement);
+
+/**
+ * @brief Look up a write policy by its command line identifier.
+ * @param char id Identifier of the policy.
+ * @return const WritePolicy* The policy, NULL if the identifier is unknown.
+ */
+INTERNAL const WritePolicy* findWritePolicy(char id);
+
+/**
+ * @brief Deinitialize a set associative cache.
+ * @param Cache* cache Cache to deinitialize.
+ * @return void
+ */
+INTERNAL void deinitCache(Cache* cache);
+
+/**
+ * @brief Reset a set associative cache's contents.
+ * @param Cache* cache Cache to reset.
  * @return void
  */
-void calculateAddressBits(void);
+INTERNAL void resetCache(Cache* cache);
 
 /**
- * @brief Extract the tag bits from an address.
- * @param unsigned int address Address to extract from.
- * @return unsigned int Tag bits.
+ * @brief Calculate bitwise breakdown of the address.
+ * @param Geometry* geometry Geometry to calculate the offset, index, and tag bits of, with its address bits set.
+ * @return int 1 if the address bits cover the offset and index bits, 0 otherwise.
+ */
+INTERNAL int calculateAddressBits(Geometry* geometry);
+
+/**
+ * @brief Mask keeping the low bits of an address.
+ * @param unsigned int addressBits Width of the addresses, up to 64.
+ * @return uint64_t The mask.
  */
-unsigned int getTagBits(unsigned int address);
+INTERNAL uint64_t getAddressMask(unsigned int addressBits);
 
 /**
- * @brief Extract the index bits from an address.
- * @param unsigned int address Address to extract from.
+ * @brief Extract the tag bits from an address, the block number's quotient by the modulus under prime modulo indexing.
+ * @param const Geometry* geometry Geometry to break the address down by.
+ * @param uint64_t address Address to extract from.
+ * @return uint64_t Tag bits.
+ */
+INTERNAL uint64_t getTagBits(const Geometry* geometry, uint64_t address);
+
+/**
+ * @brief Map an address to its set by the geometry's index function (the set of way 0 when skewed).
+ * @param const Geometry* geometry Geometry to break the address down by.
+ * @param uint64_t address Address to extract from.
  * @return unsigned int Index bits.
  */
-unsigned int getIndexBits(unsigned int address);
+INTERNAL unsigned int getIndexBits(const Geometry* geometry, uint64_t address);
 
 /**
  * @brief Extract the offset bits from an address.
- * @param unsigned int address Address to extract from.
+ * @param const Geometry* geometry Geometry to break the address down by.
+ * @param uint64_t address Address to extract from.
  * @return unsigned int Offset bits.
  */
-unsigned int getOffsetBits(unsigned int address);
+INTERNAL unsigned int getOffsetBits(const Geometry* geometry, uint64_t address);
+
+/**
+ * @brief Find the way of a set holding a tag, comparing every way at once with SSE2/AVX2 when available.
+ * @param const Cache* cache Cache to search.
+ * @param unsigned int index Set to search.
+ * @param uint64_t tag Tag to find.
+ * @return int Way holding the tag, -1 on a miss.
+ */
+INTERNAL int findWay(const Cache* cache, unsigned int index, uint64_t tag);
+
+/**
+ * @brief Find the first invalid way of a set.
+ * @param const Cache* cache Cache to search.
+ * @param unsigned int index Set to search.
+ * @return int First invalid way, -1 if the set is full.
+ */
+INTERNAL int findFreeWay(const Cache* cache, unsigned int index);
 
 /**
- * @brief 
- * @param Line* l Line to replace in cache.
- * @param int lineNum Current line number.
+ * @brief Replace the block chosen by the cache's replacement policy in a full set.
+ * @param Cache* cache Cache to replace within.
+ * @param unsigned int index Set to replace within.
+ * @param uint64_t tag Tag of the incoming block.
  * @return int Replacement index.
  */
-int lruReplace(Line* l, int lineNum);
+INTERNAL int replaceBlock(Cache* cache, unsigned int index, uint64_t tag);
 
 /**
- * @brief Cache a line.
+ * @brief Cache a line using the cache's write and replacement policies.
+ * @param Cache* cache Cache to access.
  * @param Line* l Line to add to the cache.
- * @param int lineNum Line number to cache.
- * @param cachingMethod char Method of caching to use, Write (B)ack or Write (T)hrough.
  * @return void
  */
-void cacheLine(Line* l, int lineNum ,char cachingMethod);
+INTERNAL void cacheLine(Cache* cache, Line* l);
+
+/**
+ * @brief Choose a cache's batch simulation kernel. Block sizes 32, 64 and 128 with associativities 1, 2, 4, 8 and 16
+ *        get a kernel compiled with their offset bits and associativity as constants, any other geometry the generic one.
+ * @param const Geometry* geometry Geometry of the cache, with its address bits calculated.
+ * @return SimulationKernel The kernel.
+ */
+INTERNAL SimulationKernel selectKernel(const Geometry* geometry);
+
+/**
+ * @brief Simulate a run of reads and writes to one block. References take the full path until the block is resident,
+ *        and the rest are counted as hits at once, leaving the cache exactly as referencing them one by one would.
+ * @param Cache* cache Cache to simulate.
+ * @param Line* lines References of the run, all reads or writes within one block.
+ * @param unsigned int length Number of references.
+ * @param unsigned int writes Number of the references that write.
+ * @return void
+ */
+INTERNAL void cacheRun(Cache* cache, Line* lines, unsigned int length, unsigned int writes);
 
 /**
- * @brief Simulate caching instructions using a particualr method.
- * @param char cachingMethod Method of caching to use, Write (B)ack or Write (T)hrough.
+ * @brief Simulate caching the loaded list of lines.
+ * @param Cache* cache Cache to simulate.
  * @return void
  */
-void simulate(char cachingMethod);
+INTERNAL void simulate(Cache* cache);
 
 /**
- * @brief Print the shared and basic information of the set associative cache.
+ * @brief Simulate several caches in a single pass while streaming lines from a trace, without loading the trace.
+ * @param TraceReader* reader Reader positioned after the trace header.
+ * @param Cache** caches Caches to simulate, each with its own write policy and state.
+ * @param int count Number of caches.
  * @return void
  */
-void printHeader(void);
+INTERNAL void simulateStream(TraceReader* reader, Cache** caches, int count);
 
 /**
- * @brief Print the cache report after processing.
- * @param char cachingMethod Method of caching to report Write (B)ack or Write (T)hrough.
+ * @brief Simulate several caches in a single pass while a reader thread decodes the trace, handing batches of lines
+ *        over a bounded lock-free ring so parsing overlaps with simulation.
+ * @param TraceReader* reader Reader positioned after the trace header, owned by the reader thread until it returns.
+ * @param Cache** caches Caches to simulate, each with its own write policy and state.
+ * @param int count Number of caches.
+ * @param char collapse Indicates the reader thread also run-length encodes each batch's references to one block.
  * @return void
  */
-void printCacheReport(char cachingMethod);
+INTERNAL void simulatePipelined(TraceReader* reader, Cache** caches, int count, char collapse);
 
 /**
- * @brief Print the set associative cache's contents.
+ * @brief Simulate several caches in a single pass on worker threads. Sets evolve independently, so each
+ *        worker owns a contiguous range of sets and the lines are partitioned by their index bits.
+ * @param TraceReader* reader Reader positioned after the trace header.
+ * @param Cache** caches Caches to simulate, each with its own write policy and state.
+ * @param int count Number of caches.
+ * @param unsigned int threads Number of worker threads.
  * @return void
- * @private This is a debug function.
  */
-void printCache(void);
+INTERNAL void simulateSharded(TraceReader* reader, Cache** caches, int count, unsigned int threads);
 
+// ---------- Checkpoints --------- //
 /**
- * @brief Print translated line addresses.
+ * @brief Save the full state of a run's caches (contents, replacement state, attachments, and counters) to a
+ *        versioned checkpoint. The header is little endian and the bulk arrays are written in native byte order.
+ * @param Cache** caches Caches to save.
+ * @param int count Number of caches.
+ * @param const char* path Path of the checkpoint to write.
+ * @return int 1 on success, 0 on failure.
+ */
+INTERNAL int saveCheckpoint(Cache** caches, int count, const char* path);
+
+/**
+ * @brief Restore the state of a run's caches from a memory mapped checkpoint. The caches must be configured as
+ *        the saved ones were, with the same geometry, policies, and attachments.
+ * @param Cache** caches Caches to restore into.
+ * @param int count Number of caches.
+ * @param const char* path Path of the checkpoint to read.
+ * @return int 1 on success, 0 if the checkpoint is unreadable, malformed, or from differently configured caches.
+ */
+INTERNAL int restoreCheckpoint(Cache** caches, int count, const char* path);
+
+// --------- Coherent Mode -------- //
+/**
+ * @brief Initialize cores with private write-back, write-allocate caches kept coherent by a snooping protocol.
+ * @param const Geometry* geometry Shape of every private cache, with its address bits calculated.
+ * @param unsigned int count Number of cores.
+ * @param char protocol (m)esi or m(o)esi.
+ * @return System* The new system.
+ */
+INTERNAL System* initSystem(const Geometry* geometry, unsigned int count, char protocol);
+
+/**
+ * @brief Deinitialize a coherent system.
+ * @param System* system System to deinitialize.
  * @return void
- * @private This is a debug function.
  */
-void printTranslatedLines(void);
+INTERNAL void deinitSystem(System* system);
 
-// ----------- Utilities ---------- //
 /**
- * @brief Parse input from stdin. Expects 3 integers, each on seperate lines, followed by
- *        an indefinite list of W/R address lines (char and int).
+ * @brief Access a line's core's private cache, snooping the other cores on misses and shared writes.
+ * @param System* system System to access.
+ * @param Line* l Line to access.
  * @return void
- * @private This is a debug function.
  */
-void parseInput(void);
+INTERNAL void systemAccess(System* system, Line* l);
 
 /**
- * @brief Calculate the log with explicit base.
- * @param int num The number to log.
- * @param int base The base of the log.
+ * @brief Run a coherent system over every line of a trace, on worker threads that each own a range of sets.
+ * @param TraceReader* reader Reader positioned after the trace header.
+ * @param System* system System to simulate.
+ * @param unsigned int threads Number of worker threads.
  * @return void
  */
-double logBase(int num, int base);
+INTERNAL void simulateSystem(TraceReader* reader, System* system, unsigned int threads);
+
+/**
+ * @brief Print each core's report, followed by the coherence traffic.
+ * @param System* system System to report.
+ * @return void
+ */
+INTERNAL void printSystemReport(System* system);
+
+// ---------- Sweep Mode ---------- //
+/**
+ * @brief Parse a sweep specification of block sizes, set counts, and associativities into one job per combination.
+ *        Each field is a comma separated list of values and power of two ranges (e.g. 16-128:64,256:1,2,8-32).
+ * @param const char* spec Specification to parse.
+ * @param unsigned int* count Number of jobs parsed.
+ * @return SweepJob* The jobs, NULL if the specification is malformed.
+ */
+INTERNAL SweepJob* parseSweep(const char* spec, unsigned int* count);
+
+/**
+ * @brief Simulate every job over the loaded list of lines on a work stealing thread pool.
+ * @param SweepJob* jobs Jobs to simulate.
+ * @param unsigned int count Number of jobs.
+ * @param unsigned int threads Number of worker threads.
+ * @return void
+ */
+INTERNAL void runSweep(SweepJob* jobs, unsigned int count, unsigned int threads);
+
+/**
+ * @brief Print one row per job and write policy.
+ * @param SweepJob* jobs Simulated jobs.
+ * @param unsigned int count Number of jobs.
+ * @param char format Table format, (c)sv or (j)son.
+ * @return void
+ */
+INTERNAL void printSweep(SweepJob* jobs, unsigned int count, char format);
+
+// -------- Benchmark Mode -------- //
+/**
+ * @brief Time every job and write policy over the loaded list of lines, one at a time on the calling thread.
+ *        Each is simulated repeatedly on a fresh cache and keeps its fastest pass.
+ * @param SweepJob* jobs Jobs to time.
+ * @param unsigned int count Number of jobs.
+ * @param unsigned int repeats Passes per job and write policy.
+ * @return void
+ */
+INTERNAL void runBenchmark(SweepJob* jobs, unsigned int count, unsigned int repeats);
+
+/**
+ * @brief Load the rows of an earlier benchmark's CSV.
+ * @param const char* path Path of the CSV.
+ * @param unsigned int* count Number of rows loaded.
+ * @return Baseline* The rows, NULL if the file cannot be read.
+ */
+INTERNAL Baseline* loadBaseline(const char* path, unsigned int* count);
+
+/**
+ * @brief Print the throughput of every job and write policy as CSV, compared against the baseline rows of the
+ *        same configuration when there are any.
+ * @param SweepJob* jobs Timed jobs.
+ * @param unsigned int count Number of jobs.
+ * @param const Baseline* baseline Rows to compare against (NULL compares nothing).
+ * @param unsigned int baselineCount Number of rows.
+ * @param double tolerance Slowdown allowed before a configuration is flagged, as a fraction of its baseline.
+ * @return unsigned int Number of configurations flagged as regressions.
+ */
+INTERNAL unsigned int printBenchmark(SweepJob* jobs, unsigned int count, const Baseline* baseline, unsigned int baselineCount, double tolerance);
+
+// ------ Workload Generator ------ //
+/**
+ * @brief Parse a workload specification, kind[=param]:references[:footprint[:writes[:seed]]], where kind is seq,
+ *        stride[=bytes], random, zipf[=alpha], chase, or mix and the footprint takes a K, M, or G suffix.
+ * @param const char* spec Specification to parse.
+ * @param Workload* workload Destination of the workload, defaults filled in.
+ * @return int 1 if the specification is valid, 0 otherwise.
+ */
+INTERNAL int parseWorkload(const char* spec, Workload* workload);
+
+/**
+ * @brief Write a text trace of the workload. The same workload always generates the same trace.
+ * @param const Workload* workload Workload to generate.
+ * @param FILE* out Destination of the trace.
+ * @return int 1 on success, 0 if the footprint's tables cannot be allocated.
+ */
+INTERNAL int generateWorkload(const Workload* workload, FILE* out);
+
+// ------ Stack Distance Mode ----- //
+/**
+ * @brief Initialize a stack distance engine.
+ * @param unsigned int indexBits Number of index bits, the set count is 2^indexBits.
+ * @param unsigned int depth Largest associativity to track.
+ * @return StackDistance* The new engine.
+ */
+INTERNAL StackDistance* initStackDistance(unsigned int indexBits, unsigned int depth);
+
+/**
+ * @brief Deinitialize a stack distance engine.
+ * @param StackDistance* engine Engine to deinitialize.
+ * @return void
+ */
+INTERNAL void deinitStackDistance(StackDistance* engine);
+
+/**
+ * @brief Record a reference to a block, moving it to the top of its set's stack.
+ * @param StackDistance* engine Engine to update.
+ * @param uint64_t block Block address (address without the offset bits).
+ * @return void
+ */
+INTERNAL void stackDistanceAccess(StackDistance* engine, uint64_t block);
+
+/**
+ * @brief Stream the trace through stack distance engines for every power of two set count.
+ * @param TraceReader* reader Reader positioned after the trace header.
+ * @param StackDistance** engines Engines to update, one per set count.
+ * @param int count Number of engines.
+ * @return unsigned long Number of references.
+ */
+INTERNAL unsigned long simulateStackDistance(TraceReader* reader, StackDistance** engines, int count);
+
+/**
+ * @brief Print the LRU miss-ratio curve as a table of misses for every set count and associativity.
+ * @param StackDistance** engines Engines to report, one per set count.
+ * @param int count Number of engines.
+ * @param unsigned long references Number of references.
+ * @return void
+ */
+INTERNAL void printMissRatioCurve(StackDistance** engines, int count, unsigned long references);
+
+// --------- Sampled Mode --------- //
+/**
+ * @brief Decide whether a block belongs to a spatial sample, by hashing its address with the sample's seed.
+ * @param uint64_t block Block address.
+ * @param unsigned int seed Hash seed of the sample.
+ * @param unsigned int shift The sample keeps 2^-shift of the blocks.
+ * @return int 1 if the block is sampled, 0 otherwise.
+ */
+INTERNAL int sampleBlock(uint64_t block, unsigned int seed, unsigned int shift);
+
+/**
+ * @brief Scale a geometry down to the blocks of a spatial sample by dividing its sets, so each set sees as many blocks.
+ * @param const Geometry* geometry Geometry to scale.
+ * @param unsigned int shift The sample keeps 2^-shift of the blocks.
+ * @return Geometry The scaled geometry, with its address bits calculated.
+ */
+INTERNAL Geometry scaleGeometry(const Geometry* geometry, unsigned int shift);
+
+/**
+ * @brief Stream a trace through scaled caches, feeding each sample only the references to its blocks.
+ * @param TraceReader* reader Reader positioned after the trace header.
+ * @param Cache** caches Scaled caches, seeds x policies, each sample's caches sharing one seed.
+ * @param int count Number of write policies.
+ * @param unsigned int seeds Number of samples.
+ * @param unsigned int shift Each sample keeps 2^-shift of the blocks.
+ * @return unsigned long Number of references in the trace.
+ */
+INTERNAL unsigned long simulateSampled(TraceReader* reader, Cache** caches, int count, unsigned int seeds, unsigned int shift);
+
+/**
+ * @brief Print each write policy's estimated ratios and memory references, with 95% confidence intervals across samples.
+ * @param Cache** caches Scaled caches, seeds x policies.
+ * @param int count Number of write policies.
+ * @param unsigned int seeds Number of samples.
+ * @param unsigned int shift Each sample keeps 2^-shift of the blocks.
+ * @param unsigned long references Number of references in the trace.
+ * @return void
+ */
+INTERNAL void printSampledReport(Cache** caches, int count, unsigned int seeds, unsigned int shift, unsigned long references);
+
+/**
+ * @brief Print the estimated LRU miss-ratio curve, with 95% confidence intervals across samples.
+ * @param StackDistance** engines Sampled engines, set counts x seeds.
+ * @param int count Number of set counts.
+ * @param unsigned int seeds Number of samples.
+ * @param unsigned long references Number of references in the trace.
+ * @return void
+ */
+INTERNAL void printSampledMissRatioCurve(StackDistance** engines, int count, unsigned int seeds, unsigned long references);
+
+// -------- Hierarchy Mode -------- //
+/**
+ * @brief Initialize a cache hierarchy from level specifications of the form blockSize:sets:ways:policy[:inclusion].
+ * @param const char** specs Level specifications, nearest the processor first.
+ * @param int count Number of levels.
+ * @return Hierarchy* The new hierarchy, NULL if a specification is malformed.
+ */
+INTERNAL Hierarchy* initHierarchy(const char** specs, int count);
+
+/**
+ * @brief Deinitialize a cache hierarchy.
+ * @param Hierarchy* hierarchy Hierarchy to deinitialize.
+ * @return void
+ */
+INTERNAL void deinitHierarchy(Hierarchy* hierarchy);
+
+/**
+ * @brief Access the hierarchy with a line, starting at the level nearest the processor.
+ * @param Hierarchy* hierarchy Hierarchy to access.
+ * @param Line* l Line to access.
+ * @return void
+ */
+INTERNAL void hierarchyAccess(Hierarchy* hierarchy, Line* l);
+
+/**
+ * @brief Run the hierarchy over every line of a trace.
+ * @param TraceReader* reader Reader positioned after the trace header.
+ * @param Hierarchy* hierarchy Hierarchy to run.
+ * @return void
+ */
+INTERNAL void simulateHierarchy(TraceReader* reader, Hierarchy* hierarchy);
+
+/**
+ * @brief Print each level's report, followed by the traffic reaching memory.
+ * @param Hierarchy* hierarchy Hierarchy to report.
+ * @return void
+ */
+INTERNAL void printHierarchyReport(Hierarchy* hierarchy);
+
+/**
+ * @brief Print the shared and basic information of the set associative cache.
+ * @param const Geometry* geometry Geometry to print.
+ * @return void
+ */
+INTERNAL void printHeader(const Geometry* geometry);
+
+/**
+ * @brief Print the cache report after processing.
+ * @param Cache* cache Cache to report.
+ * @return void
+ */
+INTERNAL void printCacheReport(Cache* cache);
+
+/**
+ * @brief Print the cache's average memory access time, stall cycles, and memory traffic. Demand fetches stall for the
+ *        miss penalty and writebacks and written through words for the writeback cost, while prefetches only move bytes.
+ * @param const Cache* cache Simulated cache.
+ * @param const Timing* timing Latencies of the cache.
+ * @param double bandwidth Memory bus bytes per cycle (0 leaves the bus unlimited).
+ * @return void
+ */
+INTERNAL void printTimingReport(const Cache* cache, const Timing* timing, double bandwidth);
+
+/**
+ * @brief Print the hierarchy's average memory access time, stall cycles, and memory traffic. Every level charges its
+ *        hit latency per reference, its miss penalty per block fetched from below, and its writeback cost per block
+ *        written back below, so the last level's penalty and cost are those of memory.
+ * @param const Hierarchy* hierarchy Simulated hierarchy.
+ * @param const Timing* timings Latencies of each level, nearest the processor first.
+ * @param double bandwidth Memory bus bytes per cycle (0 leaves the bus unlimited).
+ * @return void
+ */
+INTERNAL void printHierarchyTiming(const Hierarchy* hierarchy, const Timing* timings, double bandwidth);
+
+/**
+ * @brief Print the set associative cache's contents.
+ * @param Cache* cache Cache to print.
+ * @return void
+ * @private This is a debug function.
+ */
+INTERNAL void printCache(Cache* cache);
+
+/**
+ * @brief Print translated line addresses.
+ * @return void
+ * @private This is a debug function.
+ */
+INTERNAL void printTranslatedLines(void);
+
+// ----------- Utilities ---------- //
+/**
+ * @brief Load an entire trace into the list of lines. Expects 3 integers, each on seperate lines,
+ *        followed by an indefinite list of W/R address lines (char and int).
+ * @param TraceReader* reader Reader positioned at the start of the trace.
+ * @return void
+ * @private This is a debug function.
+ */
+INTERNAL void parseInput(TraceReader* reader);
+
+/**
+ * @brief Parse command line arguments into the options.
+ * @param int argc Argument count.
+ * @param char** argv Argument values.
+ * @return int 1 if the arguments are valid, 0 otherwise.
+ */
+INTERNAL int parseArguments(int argc, char** argv);
+
+/**
+ * @brief Print command line usage to stderr.
+ * @param const char* program Name of the program.
+ * @return void
+ */
+INTERNAL void printUsage(const char* program);
+
+/**
+ * @brief Calculate the log with explicit base.
+ * @param int num The number to log.
+ * @param int base The base of the log.
+ * @return void
+ */
+INTERNAL double logBase(int num, int base);
+
+/*----------------------------------*
+ *             Globals               *
+ *----------------------------------*/
+INTERNAL LineList * LINE_LIST;
+INTERNAL_DECLARATION const ReplacementPolicy REPLACEMENT_POLICIES[MAX_REPLACEMENT_POLICIES];
+INTERNAL_DECLARATION const Prefetcher PREFETCHERS[MAX_PREFETCHERS];
+INTERNAL_DECLARATION const IndexFunction INDEX_FUNCTIONS[MAX_INDEX_FUNCTIONS];
+INTERNAL Options OPTIONS =
+{
+    .policies = "TB",
+    .threads = 1,
+    .format = 'c',
+    .replacement = &REPLACEMENT_POLICIES[0],
+    .seeds = 4,
+    .addressBits = 32,
+    .tolerance = BENCH_TOLERANCE,
+    .indexing = &INDEX_FUNCTIONS[0],
+    .dram = {.page = 'o', .depth = DRAM_QUEUE_DEPTH, .gap = DRAM_GAP}
+};
+INTERNAL const WritePolicy WRITE_POLICIES[MAX_POLICIES] =
+{
+    {'T', 0, 0, "Write-through with No Write Allocate"},
+    {'B', 1, 1, "Write-back with Write Allocate"},
+    {'A', 0, 1, "Write-through with Write Allocate"},
+    {'N', 1, 0, "Write-back with No Write Allocate"}
+};
+INTERNAL Geometry GEOMETRY;
+
+/*----------------------------------*
+ *          IMPLEMENTATIONS         *
+ *----------------------------------*/
+void initLines(void)
+{
+    LINE_LIST = (LineList*) malloc(sizeof(LineList));
+    LINE_LIST->lines = (Line*) malloc(sizeof(Line));
+    LINE_LIST->size = 0;
+    LINE_LIST->capacity = 1;
+}
+
+void deinitLines(void)
+{
+    free(LINE_LIST->lines);
+    free(LINE_LIST);
+}
+
+void addLine(char operation, uint64_t address)
+{
+    LINE_LIST->size += 1;
+    if(LINE_LIST->size > LINE_LIST->capacity)
+    {
+        LINE_LIST->capacity *= 2;
+        LINE_LIST->lines = (Line*)realloc(LINE_LIST->lines, sizeof(Line)*LINE_LIST->capacity);
+    }
+    LINE_LIST->lines[LINE_LIST->size-1].address = address;
+    LINE_LIST->lines[LINE_LIST->size-1].operation = operation;
+    LINE_LIST->lines[LINE_LIST->size-1].core = 0;
+}
+
+void printLines(void)
+{
+    unsigned int i;
+    for(i = 0; i < LINE_LIST->size; i++)
+    {
+        printf("%c %llu\n", LINE_LIST->lines[i].operation, (unsigned long long)LINE_LIST->lines[i].address);
+    }
+}
+
+void parseInput(TraceReader* reader)
+{
+    // Get Base Variables
+    readTraceHeader(reader);
+
+    // Indefinite Line Input
+    loadLines(reader);
+}
+
+void loadLines(TraceReader* reader)
+{
+    Line lines[TRACE_BATCH_SIZE];
+    unsigned int size;
+    while((size = readTraceBatch(reader, lines, TRACE_BATCH_SIZE)) > 0)
+    {
+        unsigned int i;
+        for(i = 0; i < size; i++)
+        {
+            addLine(lines[i].operation, lines[i].address);
+        }
+    }
+}
+
+/**
+ * @brief Carry the unparsed bytes to the front of the buffer and read the next chunk behind them.
+ * @param TraceReader* reader Reader to refill.
+ * @return size_t Number of bytes read, 0 at the end of the stream or when the buffer is full.
+ */
+static size_t refillTraceReader(TraceReader* reader)
+{
+    if(reader->eof)
+        return 0;
+
+    size_t remaining = reader->length - reader->position;
+    memmove(reader->buffer, reader->buffer + reader->position, remaining);
+    reader->position = 0;
+    reader->length = remaining;
+
+    size_t got = fread(reader->buffer + remaining, 1, TRACE_CHUNK_SIZE - remaining, reader->stream);
+    reader->length += got;
+    if(got == 0 && remaining < TRACE_CHUNK_SIZE)
+        reader->eof = 1;
+    return got;
+}
+
+/**
+ * @brief Ensure a number of bytes are buffered past the parse position.
+ * @param TraceReader* reader Reader to refill.
+ * @param size_t count Number of bytes required.
+ * @return int 1 if the bytes are buffered, 0 if the trace ends first.
+ */
+static int ensureTraceBytes(TraceReader* reader, size_t count)
+{
+    while(reader->length - reader->position < count && refillTraceReader(reader) > 0);
+    return reader->length - reader->position >= count;
+}
+
+/**
+ * @brief Ensure a complete line (or the rest of the trace) is buffered past the parse position.
+ * @param TraceReader* reader Reader to refill.
+ * @return int 1 if unparsed bytes remain, 0 at the end of the trace.
+ */
+static int fillTraceReader(TraceReader* reader)
+{
+    while(!memchr(reader->buffer + reader->position, '\n', reader->length - reader->position) && refillTraceReader(reader) > 0);
+    return reader->position < reader->length;
+}
+
+TraceReader* openTraceReader(const char* path)
+{
+    TraceReader* reader = (TraceReader*)calloc(1, sizeof(TraceReader));
+    // Converted Traces Keep Every Address Whole, so the Width is Chosen When They are Simulated
+    reader->addressMask = OPTIONS.convertPath ? UINT64_MAX : getAddressMask(OPTIONS.addressBits);
+
+    if(path)
+    {
+        int fd = open(path, O_RDONLY);
+        if(fd < 0)
+        {
+            fprintf(stderr, "Unable to open trace %s\n", path);
+            free(reader);
+            return NULL;
+        }
+
+        // Map the Whole Trace, Falling Back to Chunked Reads (Pipes, Empty Files)
+        struct stat info;
+        if(fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0)
+        {
+            void* mapping = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if(mapping != MAP_FAILED)
+            {
+                madvise(mapping, info.st_size, MADV_SEQUENTIAL);
+                reader->buffer = (char*)mapping;
+                reader->length = info.st_size;
+                reader->mapped = 1;
+                reader->eof = 1;
+                close(fd);
+                reader->binary = (reader->length >= 4 && memcmp(reader->buffer, BINARY_TRACE_MAGIC, 4) == 0);
+                return reader;
+            }
+        }
+        close(fd);
+
+        reader->stream = fopen(path, "r");
+        if(!reader->stream)
+        {
+            fprintf(stderr, "Unable to open trace %s\n", path);
+            free(reader);
+            return NULL;
+        }
+    }
+    else
+    {
+        reader->stream = stdin;
+    }
+
+    reader->buffer = (char*)malloc(TRACE_CHUNK_SIZE);
+    reader->binary = (ensureTraceBytes(reader, 4) && memcmp(reader->buffer, BINARY_TRACE_MAGIC, 4) == 0);
+    return reader;
+}
+
+void closeTraceReader(TraceReader* reader)
+{
+    if(reader->mapped)
+    {
+        munmap(reader->buffer, reader->length);
+    }
+    else
+    {
+        if(reader->stream != stdin)
+            fclose(reader->stream);
+        free(reader->buffer);
+    }
+    free(reader);
+}
+
+/**
+ * @brief Skip whitespace (including newlines) at the parse position.
+ * @param TraceReader* reader Reader to advance.
+ * @return int 1 if unparsed bytes remain, 0 at the end of the trace.
+ */
+static int skipTraceWhitespace(TraceReader* reader)
+{
+    while(fillTraceReader(reader))
+    {
+        char* cursor = reader->buffer + reader->position;
+        char* end = reader->buffer + reader->length;
+        while(cursor < end && (*cursor == ' ' || *cursor == '\t' || *cursor == '\n' || *cursor == '\r'))
+            cursor++;
+        reader->position = cursor - reader->buffer;
+
+        // Make Sure the Line Starting Here is Fully Buffered
+        if(cursor < end)
+            return fillTraceReader(reader);
+    }
+    return 0;
+}
+
+/**
+ * @brief Parse an optionally signed decimal integer at the parse position.
+ * @param TraceReader* reader Reader to parse from, with the number already buffered.
+ * @return uint64_t The parsed value, negative values wrapped to unsigned like the "%d" input it replaces.
+ */
+static uint64_t parseTraceNumber(TraceReader* reader)
+{
+    char* cursor = reader->buffer + reader->position;
+    char* end = reader->buffer + reader->length;
+    while(cursor < end && (*cursor == ' ' || *cursor == '\t'))
+        cursor++;
+
+    int negative = 0;
+    if(cursor < end && (*cursor == '-' || *cursor == '+'))
+    {
+        negative = (*cursor == '-');
+        cursor++;
+    }
+
+    uint64_t value = 0;
+    while(cursor < end && *cursor >= '0' && *cursor <= '9')
+    {
+        value = value * 10 + (*cursor - '0');
+        cursor++;
+    }
+    reader->position = cursor - reader->buffer;
+    return negative ? 0 - value : value;
+}
+
+int readTraceInteger(TraceReader* reader, unsigned int* value)
+{
+    if(!skipTraceWhitespace(reader))
+        return 0;
+    *value = (unsigned int)parseTraceNumber(reader);
+    return 1;
+}
+
+/**
+ * @brief Read a little endian integer from a byte buffer.
+ * @param const unsigned char* bytes Buffer to read from.
+ * @param int width Number of bytes in the integer.
+ * @return uint64_t The integer.
+ */
+static uint64_t getLittleEndian(const unsigned char* bytes, int width)
+{
+    uint64_t value = 0;
+    int i;
+    for(i = width - 1; i >= 0; i--)
+        value = (value << 8) | bytes[i];
+    return value;
+}
+
+/**
+ * @brief Write a little endian integer to a byte buffer.
+ * @param unsigned char* bytes Buffer to write to.
+ * @param uint64_t value The integer.
+ * @param int width Number of bytes in the integer.
+ * @return unsigned char* The buffer position after the integer.
+ */
+static unsigned char* putLittleEndian(unsigned char* bytes, uint64_t value, int width)
+{
+    int i;
+    for(i = 0; i < width; i++)
+    {
+        bytes[i] = value & 0xFF;
+        value >>= 8;
+    }
+    return bytes + width;
+}
+
+/**
+ * @brief Decode records from the binary trace, starting the next block when the current one is done.
+ * @param TraceReader* reader Reader to decode from.
+ * @param Line* lines Destination of the decoded lines.
+ * @param unsigned int max Maximum number of lines to decode.
+ * @return unsigned int Number of lines decoded, 0 at the end of the trace.
+ */
+static unsigned int decodeBinaryRecords(TraceReader* reader, Line* lines, unsigned int max)
+{
+    if(reader->blockRemaining == 0)
+    {
+        // Start the Next Block, Buffering it Entirely
+        if(!ensureTraceBytes(reader, BINARY_BLOCK_HEADER_SIZE))
+            return 0;
+        const unsigned char* header = (const unsigned char*)reader->buffer + reader->position;
+        unsigned int records = getLittleEndian(header, 4);
+        reader->blockCores = (records & BINARY_BLOCK_CORES) != 0;
+        reader->blockWide = (records & BINARY_BLOCK_WIDE) != 0;
+        records &= ~(BINARY_BLOCK_CORES | BINARY_BLOCK_WIDE);
+        size_t bytes = getLittleEndian(header + 4, 4);
+        if(!ensureTraceBytes(reader, BINARY_BLOCK_HEADER_SIZE + bytes))
+        {
+            fprintf(stderr, "Truncated binary trace block\n");
+            return 0;
+        }
+        reader->position += BINARY_BLOCK_HEADER_SIZE;
+        reader->blockEnd = reader->position + bytes;
+        reader->blockRemaining = records;
+        reader->blockAddress = 0;
+    }
+
+    unsigned int count = reader->blockRemaining < max ? reader->blockRemaining : max;
+    const unsigned char* cursor = (const unsigned char*)reader->buffer + reader->position;
+    const unsigned char* end = (const unsigned char*)reader->buffer + reader->blockEnd;
+    uint64_t address = reader->blockAddress;
+    uint64_t wrap = reader->blockWide ? UINT64_MAX : 0xFFFFFFFFu;
+    unsigned int i;
+    int malformed = 0;
+    for(i = 0; i < count && !malformed; i++)
+    {
+        // Varint: Op Bit Followed by the Zigzag Encoded Address Delta, up to 65 Bits so the Op Bit is Peeled Off First
+        if(cursor >= end)
+        {
+            malformed = 1;
+            break;
+        }
+        unsigned char byte = *cursor++;
+        int write = byte & 1;
+        uint64_t zigzag = (byte & 0x7F) >> 1;
+        int shift = 6;
+        while(byte & 0x80)
+        {
+            if(cursor >= end)
+            {
+                malformed = 1;
+                break;
+            }
+            byte = *cursor++;
+            zigzag |= (uint64_t)(byte & 0x7F) << shift;
+            shift += 7;
+        }
+
+        // Narrow Blocks Wrap at 32 Bits, Wide Blocks at 64
+        address = (address + ((zigzag >> 1) ^ (0 - (zigzag & 1)))) & wrap;
+        lines[i].operation = write ? 'W' : 'R';
+        lines[i].address = address & reader->addressMask;
+
+        // Core Varint
+        unsigned int core = 0;
+        if(reader->blockCores && !malformed)
+        {
+            shift = 0;
+            do
+            {
+                if(cursor >= end)
+                {
+                    malformed = 1;
+                    break;
+                }
+                byte = *cursor++;
+                core |= (unsigned int)(byte & 0x7F) << shift;
+                shift += 7;
+            } while(byte & 0x80);
+        }
+        lines[i].core = core;
+    }
+
+    // A Record Running Past its Block Rejects the Rest of the Block, Ending the Trace
+    if(malformed)
+    {
+        fprintf(stderr, "Malformed binary trace block\n");
+        reader->position = reader->blockEnd;
+        reader->blockRemaining = 0;
+        return 0;
+    }
+
+    reader->position = cursor - (const unsigned char*)reader->buffer;
+    reader->blockAddress = address;
+    reader->blockRemaining = (i < count) ? 0 : reader->blockRemaining - count;
+    return i;
+}
+
+int readTraceLine(TraceReader* reader, Line* l)
+{
+    if(reader->binary)
+        return decodeBinaryRecords(reader, l, 1);
+
+    if(!skipTraceWhitespace(reader))
+        return 0;
+
+    // Optional Core ID Ahead of the Operation
+    l->core = 0;
+    char* cursor = reader->buffer + reader->position;
+    if(*cursor >= '0' && *cursor <= '9')
+    {
+        l->core = parseTraceNumber(reader);
+        cursor = reader->buffer + reader->position;
+        while(cursor < reader->buffer + reader->length && (*cursor == ' ' || *cursor == '\t'))
+            cursor++;
+        reader->position = cursor - reader->buffer;
+        if(cursor == reader->buffer + reader->length)
+            return 0;
+    }
+
+    l->operation = reader->buffer[reader->position++];
+    l->address = parseTraceNumber(reader) & reader->addressMask;
+    return 1;
+}
+
+unsigned int readTraceBatch(TraceReader* reader, Line* lines, unsigned int max)
+{
+    if(reader->binary)
+        return decodeBinaryRecords(reader, lines, max);
+
+    unsigned int count = 0;
+    while(count < max && readTraceLine(reader, &lines[count]))
+        count++;
+    return count;
+}
+
+int readTraceHeader(TraceReader* reader)
+{
+    if(!reader->binary)
+    {
+        return readTraceInteger(reader, &GEOMETRY.blockSize) &&
+               readTraceInteger(reader, &GEOMETRY.numSets) &&
+               readTraceInteger(reader, &GEOMETRY.associativity);
+    }
+
+    if(!ensureTraceBytes(reader, BINARY_TRACE_HEADER_SIZE))
+        return 0;
+    const unsigned char* header = (const unsigned char*)reader->buffer + reader->position;
+    uint64_t version = getLittleEndian(header + 4, 4);
+    if(version != BINARY_TRACE_VERSION && version != BINARY_TRACE_CORES_VERSION && version != BINARY_TRACE_WIDE_VERSION)
+    {
+        fprintf(stderr, "Unsupported binary trace version %u\n", (unsigned int)version);
+        return 0;
+    }
+    GEOMETRY.blockSize = getLittleEndian(header + 8, 4);
+    GEOMETRY.numSets = getLittleEndian(header + 12, 4);
+    GEOMETRY.associativity = getLittleEndian(header + 16, 4);
+    reader->position += BINARY_TRACE_HEADER_SIZE;
+    return 1;
+}
+
+int convertTrace(TraceReader* reader, const char* path)
+{
+    FILE* out = fopen(path, "wb");
+    if(!out)
+    {
+        fprintf(stderr, "Unable to create binary trace %s\n", path);
+        return 0;
+    }
+
+    // Header (Record Count is Patched Once the Trace Has Been Read)
+    unsigned char header[BINARY_TRACE_HEADER_SIZE];
+    unsigned char* cursor = header;
+    memcpy(cursor, BINARY_TRACE_MAGIC, 4);
+    cursor = putLittleEndian(cursor + 4, BINARY_TRACE_VERSION, 4);
+    cursor = putLittleEndian(cursor, GEOMETRY.blockSize, 4);
+    cursor = putLittleEndian(cursor, GEOMETRY.numSets, 4);
+    cursor = putLittleEndian(cursor, GEOMETRY.associativity, 4);
+    putLittleEndian(cursor, 0, 8);
+    fwrite(header, 1, BINARY_TRACE_HEADER_SIZE, out);
+
+    // Blocks of Records, Each Encoded Against an Address of 0 at its Start (a Record Takes at Most 10 + 3 Bytes)
+    Line lines[TRACE_BATCH_SIZE];
+    unsigned char block[BINARY_BLOCK_HEADER_SIZE + TRACE_BATCH_SIZE * 13];
+    uint64_t total = 0;
+    int cores = 0;
+    int wide = 0;
+    unsigned int count;
+    while((count = readTraceBatch(reader, lines, TRACE_BATCH_SIZE)) > 0)
+    {
+        unsigned char* payload = block + BINARY_BLOCK_HEADER_SIZE;
+        uint64_t previous = 0;
+        unsigned int i;
+
+        // Blocks Carry Core IDs Only When a Line Comes From a Core Other Than 0, and
+        // Wrap Their Deltas at 64 Bits Only When an Address Needs More Than 32
+        int blockCores = 0;
+        int blockWide = 0;
+        for(i = 0; i < count; i++)
+        {
+            blockCores |= (lines[i].core != 0);
+            blockWide |= (lines[i].address >> 32) != 0;
+        }
+        cores |= blockCores;
+        wide |= blockWide;
+
+        for(i = 0; i < count; i++)
+        {
+            if(lines[i].operation != 'R' && lines[i].operation != 'W')
+            {
+                fprintf(stderr, "Unsupported operation '%c' at line %llu\n", lines[i].operation, (unsigned long long)(total + i + 1));
+                fclose(out);
+                remove(path);
+                return 0;
+            }
+
+            int64_t delta = blockWide ? (int64_t)(lines[i].address - previous) : (int32_t)(lines[i].address - previous);
+            uint64_t zigzag = ((uint64_t)delta << 1) ^ (uint64_t)(delta >> 63);
+            *payload = ((zigzag & 0x3F) << 1) | (lines[i].operation == 'W');
+            zigzag >>= 6;
+            while(zigzag)
+            {
+                *payload++ |= 0x80;
+                *payload = zigzag & 0x7F;
+                zigzag >>= 7;
+            }
+            payload++;
+            previous = lines[i].address;
+
+            if(blockCores)
+            {
+                unsigned int core = lines[i].core;
+                while(core >= 0x80)
+                {
+                    *payload++ = (core & 0x7F) | 0x80;
+                    core >>= 7;
+                }
+                *payload++ = core;
+            }
+        }
+
+        size_t bytes = payload - (block + BINARY_BLOCK_HEADER_SIZE);
+        putLittleEndian(putLittleEndian(block, count | (blockCores ? BINARY_BLOCK_CORES : 0) | (blockWide ? BINARY_BLOCK_WIDE : 0), 4), bytes, 4);
+        fwrite(block, 1, BINARY_BLOCK_HEADER_SIZE + bytes, out);
+        total += count;
+    }
+
+    putLittleEndian(header, total, 8);
+    fseek(out, 20, SEEK_SET);
+    fwrite(header, 1, 8, out);
+    if(cores || wide)
+    {
+        putLittleEndian(header, wide ? BINARY_TRACE_WIDE_VERSION : BINARY_TRACE_CORES_VERSION, 4);
+        fseek(out, 4, SEEK_SET);
+        fwrite(header, 1, 4, out);
+    }
+    if(fclose(out) != 0)
+    {
+        fprintf(stderr, "Unable to write binary trace %s\n", path);
+        return 0;
+    }
+    return 1;
+}
+
+const WritePolicy* findWritePolicy(char id)
+{
+    int i;
+    for(i = 0; i < MAX_POLICIES; i++)
+    {
+        if(WRITE_POLICIES[i].id == id)
+            return &WRITE_POLICIES[i];
+    }
+    return NULL;
+}
+
+const ReplacementPolicy* findReplacementPolicy(const char* name)
+{
+    int i;
+    for(i = 0; i < MAX_REPLACEMENT_POLICIES; i++)
+    {
+        if(strcmp(REPLACEMENT_POLICIES[i].name, name) == 0)
+            return &REPLACEMENT_POLICIES[i];
+    }
+    return NULL;
+}
+
+INTERNAL const IndexFunction INDEX_FUNCTIONS[MAX_INDEX_FUNCTIONS] =
+{
+    {0, "mod", "Modulo"},
+    {'x', "xor", "XOR-Folded"},
+    {'p', "prime", "Prime Modulo"},
+    {'s', "skew", "Skewed-Associative"}
+};
+
+const IndexFunction* findIndexFunction(const char* name)
+{
+    int i;
+    for(i = 0; i < MAX_INDEX_FUNCTIONS; i++)
+    {
+        if(strcmp(INDEX_FUNCTIONS[i].name, name) == 0)
+            return &INDEX_FUNCTIONS[i];
+    }
+    return NULL;
+}
+
+int supportsReplacement(const Geometry* geometry, const ReplacementPolicy* replacement)
+{
+    return !replacement->powerOfTwo || (geometry->associativity & (geometry->associativity - 1)) == 0;
+}
+
+Cache* initCache(const Geometry* geometry, const WritePolicy* policy, const ReplacementPolicy* replacement)
+{
+    Cache* cache = (Cache*)malloc(sizeof(Cache));
+    cache->geometry = *geometry;
+    cache->policy = policy;
+    cache->replacement = replacement;
+    cache->kernel = selectKernel(geometry);
+    cache->maskWords = (geometry->associativity + 63) / 64;
+    // Keep Each Set's State 8 Byte Aligned (Skewed Caches Stamp Each Way Instead, Their Sets Differing by Way)
+    cache->stateBytes = (replacement->stateBytes(geometry->associativity) + 7) & ~7u;
+    if(geometry->indexing == 's')
+        cache->stateBytes = sizeof(uint64_t) * geometry->associativity;
+
+    // Store Tags Only as Wide as the Geometry's Tag Bits Need
+    size_t ways = (size_t)geometry->numSets * geometry->associativity;
+    cache->tagBytes = geometry->tagBits <= 16 ? 2 : geometry->tagBits <= 32 ? 4 : 8;
+    cache->tags = malloc((size_t)cache->tagBytes * ways);
+    cache->valid = (uint64_t*)malloc(sizeof(uint64_t) * geometry->numSets * cache->maskWords);
+    cache->dirty = (uint64_t*)malloc(sizeof(uint64_t) * geometry->numSets * cache->maskWords);
+    cache->state = (unsigned char*)malloc((size_t)cache->stateBytes * geometry->numSets);
+    cache->prefetcher = NULL;
+    cache->victims = NULL;
+    cache->classifier = NULL;
+    cache->intervals = NULL;
+    cache->dram = NULL;
+
+    resetCache(cache);
+    return cache;
+}
+
+/**
+ * @brief Give a cache's prefetcher fresh state, with no block marked prefetched or polluted.
+ * @param Cache* cache Cache with a prefetcher attached.
+ * @return void
+ */
+static void resetPrefetcher(Cache* cache)
+{
+    memset(cache->prefetchState, 0, cache->prefetcher->stateBytes);
+    memset(cache->prefetched, 0, sizeof(uint64_t) * cache->geometry.numSets * cache->maskWords);
+    memset(cache->polluted, 0, sizeof(uint64_t) * cache->geometry.numSets * cache->maskWords);
+}
+
+/**
+ * @brief Empty a victim or miss cache.
+ * @param VictimCache* victims Buffer to empty.
+ * @return void
+ */
+static void resetVictimCache(VictimCache* victims)
+{
+    memset(victims->used, 0, sizeof(unsigned long) * victims->entries);
+    victims->clock = 0;
+}
+
+/**
+ * @brief Empty a classifier's fully associative shadow and forget every block it has seen.
+ * @param Classifier* classifier Classifier to empty.
+ * @return void
+ */
+static void resetClassifier(Classifier* classifier)
+{
+    classifier->size = 0;
+    classifier->head = NO_BLOCK;
+    classifier->tail = NO_BLOCK;
+    memset(classifier->nodes, 0xFF, sizeof(unsigned int) * (classifier->nodeMask + 1));
+    free(classifier->seen);
+    classifier->seenMask = 1023;
+    classifier->seenCount = 0;
+    classifier->seen = (uint64_t*)malloc(sizeof(uint64_t) * (classifier->seenMask + 1));
+    memset(classifier->seen, 0xFF, sizeof(uint64_t) * (classifier->seenMask + 1));
+}
+
+/**
+ * @brief Start a cache's interval time series over, its first interval beginning at the cache's current counters.
+ * @param Cache* cache Cache with an interval time series attached.
+ * @return void
+ */
+static void resetIntervalLog(Cache* cache)
+{
+    IntervalLog* intervals = cache->intervals;
+    free(intervals->stamps);
+    intervals->stamps = (unsigned int*)calloc(intervals->mask + 1, sizeof(unsigned int));
+    intervals->count = 0;
+    intervals->unique = 0;
+    intervals->references = cache->cacheReferences;
+    intervals->misses = cache->misses;
+    intervals->writebacks = cache->writebacks;
+    intervals->memrefs = cache->memrefs;
+}
+
+/**
+ * @brief Close every row of a DRAM and idle its banks, bus, and queue.
+ * @param Dram* dram DRAM to idle.
+ * @return void
+ */
+static void resetDram(Dram* dram)
+{
+    unsigned int bank;
+    for(bank = 0; bank < dram->config.banks; bank++)
+    {
+        dram->openRows[bank] = NO_ROW;
+        dram->readyAt[bank] = 0;
+    }
+    dram->size = 0;
+    dram->clock = 0;
+    dram->busFree = 0;
+    dram->delay = 0;
+}
+
+void setClassifier(Cache* cache)
+{
+    Classifier* classifier = (Classifier*)malloc(sizeof(Classifier));
+    classifier->capacity = cache->geometry.numSets * cache->geometry.associativity;
+    classifier->blocks = (uint64_t*)malloc(sizeof(uint64_t) * classifier->capacity);
+    classifier->prev = (unsigned int*)malloc(sizeof(unsigned int) * classifier->capacity);
+    classifier->next = (unsigned int*)malloc(sizeof(unsigned int) * classifier->capacity);
+
+    // Keep the Map at Most Half Full
+    unsigned int slots = 2;
+    while(slots < classifier->capacity * 2)
+        slots *= 2;
+    classifier->nodes = (unsigned int*)malloc(sizeof(unsigned int) * slots);
+    classifier->nodeMask = slots - 1;
+    classifier->seen = NULL;
+    classifier->counts = (unsigned long*)calloc((size_t)cache->geometry.numSets * 3, sizeof(unsigned long));
+    resetClassifier(classifier);
+    cache->classifier = classifier;
+}
+
+void setIntervalLog(Cache* cache, unsigned long length, unsigned long warmup, FILE* out)
+{
+    IntervalLog* intervals = (IntervalLog*)malloc(sizeof(IntervalLog));
+    intervals->length = length;
+    intervals->warmup = warmup;
+    intervals->out = out;
+    intervals->mask = 1023;
+    intervals->blocks = (uint64_t*)malloc(sizeof(uint64_t) * (intervals->mask + 1));
+    intervals->stamps = NULL;
+    cache->intervals = intervals;
+    resetIntervalLog(cache);
+}
+
+void setVictimCache(Cache* cache, char kind, unsigned int entries)
+{
+    VictimCache* victims = (VictimCache*)calloc(1, sizeof(VictimCache));
+    victims->kind = kind;
+    victims->entries = entries;
+    victims->blocks = (uint64_t*)malloc(sizeof(uint64_t) * entries);
+    victims->used = (unsigned long*)malloc(sizeof(unsigned long) * entries);
+    resetVictimCache(victims);
+    cache->victims = victims;
+}
+
+void setDram(Cache* cache, const DramConfig* config)
+{
+    Dram* dram = (Dram*)calloc(1, sizeof(Dram));
+    dram->config = *config;
+    dram->openRows = (uint64_t*)malloc(sizeof(uint64_t) * config->banks);
+    dram->readyAt = (unsigned long*)malloc(sizeof(unsigned long) * config->banks);
+    dram->queue = (DramRequest*)malloc(sizeof(DramRequest) * config->depth);
+    resetDram(dram);
+    cache->dram = dram;
+}
+
+void setPrefetcher(Cache* cache, const Prefetcher* prefetcher)
+{
+    size_t words = (size_t)cache->geometry.numSets * cache->maskWords;
+    cache->prefetcher = prefetcher;
+    cache->prefetchState = (unsigned char*)malloc(prefetcher->stateBytes);
+    cache->prefetched = (uint64_t*)malloc(sizeof(uint64_t) * words);
+    cache->pollutedTags = malloc((size_t)cache->tagBytes * cache->geometry.numSets * cache->geometry.associativity);
+    cache->polluted = (uint64_t*)malloc(sizeof(uint64_t) * words);
+    resetPrefetcher(cache);
+}
+
+void deinitCache(Cache* cache)
+{
+    free(cache->tags);
+    free(cache->valid);
+    free(cache->dirty);
+    free(cache->state);
+    if(cache->prefetcher)
+    {
+        free(cache->prefetchState);
+        free(cache->prefetched);
+        free(cache->pollutedTags);
+        free(cache->polluted);
+    }
+    if(cache->victims)
+    {
+        free(cache->victims->blocks);
+        free(cache->victims->used);
+        free(cache->victims);
+    }
+    if(cache->classifier)
+    {
+        free(cache->classifier->blocks);
+        free(cache->classifier->prev);
+        free(cache->classifier->next);
+        free(cache->classifier->nodes);
+        free(cache->classifier->seen);
+        free(cache->classifier->counts);
+        free(cache->classifier);
+    }
+    if(cache->intervals)
+    {
+        free(cache->intervals->blocks);
+        free(cache->intervals->stamps);
+        free(cache->intervals);
+    }
+    if(cache->dram)
+    {
+        free(cache->dram->openRows);
+        free(cache->dram->readyAt);
+        free(cache->dram->queue);
+        free(cache->dram);
+    }
+    free(cache);
+}
+
+/**
+ * @brief Zero a cache's counters (and those of its attachments) without touching its contents.
+ * @param Cache* cache Cache to clear.
+ * @return void
+ */
+static void clearCounters(Cache* cache)
+{
+    if(cache->victims)
+        cache->victims->hits = 0;
+    if(cache->classifier)
+        memset(cache->classifier->counts, 0, sizeof(unsigned long) * cache->geometry.numSets * 3);
+    if(cache->intervals)
+    {
+        cache->intervals->references = 0;
+        cache->intervals->misses = 0;
+        cache->intervals->writebacks = 0;
+        cache->intervals->memrefs = 0;
+    }
+    if(cache->dram)
+    {
+        // Serve the Requests Already Queued, so Every Request Counted Was Issued Since the Counters Were Cleared
+        Dram* dram = cache->dram;
+        drainDram(dram);
+        dram->elapsed += cache->cacheReferences;
+        dram->requests = 0;
+        dram->writes = 0;
+        dram->rowHits = 0;
+        dram->rowMisses = 0;
+        dram->conflicts = 0;
+        dram->latency = 0;
+        dram->stalls = 0;
+    }
+
+    cache->hits = 0;
+    cache->misses = 0;
+    cache->memrefs = 0;
+    cache->writebacks = 0;
+    cache->fetches = 0;
+    cache->cacheReferences = 0;
+    cache->prefetches = 0;
+    cache->usefulPrefetches = 0;
+    cache->pollution = 0;
+}
+
+void resetCache(Cache* cache)
+{
+    size_t ways = (size_t)cache->geometry.numSets * cache->geometry.associativity;
+    memset(cache->tags, 0, (size_t)cache->tagBytes * ways);
+    memset(cache->valid, 0, sizeof(uint64_t) * cache->geometry.numSets * cache->maskWords);
+    memset(cache->dirty, 0, sizeof(uint64_t) * cache->geometry.numSets * cache->maskWords);
+    memset(cache->state, 0, (size_t)cache->stateBytes * cache->geometry.numSets);
+    cache->lastBlock = NO_ADDRESS;
+    cache->clock = 0;
+    unsigned int i;
+    for(i = 0; i < cache->geometry.numSets && cache->geometry.indexing != 's'; i++)
+    {
+        cache->replacement->init(&cache->state[(size_t)i * cache->stateBytes], cache->geometry.associativity, i);
+    }
+
+    if(cache->prefetcher)
+        resetPrefetcher(cache);
+    if(cache->victims)
+        resetVictimCache(cache->victims);
+    if(cache->classifier)
+        resetClassifier(cache->classifier);
+    if(cache->intervals)
+        resetIntervalLog(cache);
+    if(cache->dram)
+        resetDram(cache->dram);
+
+    clearCounters(cache);
+}
+
+int calculateAddressBits(Geometry* geometry)
+{
+    // Prime Modulo Indexing Leaves the Sets Above the Largest Prime Unused
+    geometry->modulus = geometry->numSets;
+    if(geometry->indexing == 'p')
+    {
+        unsigned int divisor = 2;
+        while(geometry->modulus > 2 && divisor * divisor <= geometry->modulus)
+        {
+            if(geometry->modulus % divisor == 0)
+            {
+                geometry->modulus--;
+                divisor = 2;
+            }
+            else
+                divisor++;
+        }
+    }
+
+    geometry->offsetBits = logBase(geometry->blockSize,2);
+    geometry->indexBits = logBase(geometry->modulus,2);
+    geometry->tagBits = geometry->addressBits - geometry->offsetBits - geometry->indexBits;
+    return geometry->offsetBits + geometry->indexBits <= geometry->addressBits;
+}
+
+uint64_t getAddressMask(unsigned int addressBits)
+{
+    return addressBits >= 64 ? UINT64_MAX : ((uint64_t)1 << addressBits) - 1;
+}
+
+/**
+ * @brief Fold a value into a number of bits by exclusive or of its chunks.
+ * @param uint64_t value Value to fold.
+ * @param unsigned int bits Width of the result.
+ * @return uint64_t The folded value, 0 if bits is 0.
+ */
+static uint64_t foldBits(uint64_t value, unsigned int bits)
+{
+    if(bits == 0)
+        return 0;
+    uint64_t mask = ((uint64_t)1 << bits) - 1;
+    uint64_t folded = 0;
+    while(value)
+    {
+        folded ^= value & mask;
+        value >>= bits;
+    }
+    return folded;
+}
+
+/**
+ * @brief Hash of a tag, exclusive or'd into the low block bits to pick the set of a way under xor or skewed indexing.
+ *        Each way of a skewed cache scrambles the tag by its own odd multiplier, so blocks sharing a set in one way
+ *        rarely share one in the others.
+ * @param const Geometry* geometry Geometry of the cache.
+ * @param uint64_t tag Tag of the block.
+ * @param unsigned int way Way to index (ignored unless skewed).
+ * @return unsigned int Bits to exclusive or into the index.
+ */
+static unsigned int hashTag(const Geometry* geometry, uint64_t tag, unsigned int way)
+{
+    if(geometry->indexing == 's')
+        tag *= SKEW_MULTIPLIER * (2 * (uint64_t)way + 1);
+    return foldBits(tag, geometry->indexBits);
+}
+
+/**
+ * @brief Set of a block in one way of a cache under xor or skewed indexing.
+ * @param const Geometry* geometry Geometry of the cache.
+ * @param uint64_t block Block number, the address without its offset bits.
+ * @param unsigned int way Way to index.
+ * @return unsigned int The set.
+ */
+static unsigned int hashedIndex(const Geometry* geometry, uint64_t block, unsigned int way)
+{
+    return (block ^ hashTag(geometry, block >> geometry->indexBits, way)) & ((1u << geometry->indexBits) - 1);
+}
+
+uint64_t getTagBits(const Geometry* geometry, uint64_t address)
+{
+    if(geometry->indexing == 'p')
+        return (address >> geometry->offsetBits) / geometry->modulus;
+    return address >> (geometry->offsetBits+geometry->indexBits);
+}
+
+unsigned int getIndexBits(const Geometry* geometry, uint64_t address)
+{
+    uint64_t block = address >> geometry->offsetBits;
+    if(geometry->indexing == 'p')
+        return block % geometry->modulus;
+    if(geometry->indexing)
+        return hashedIndex(geometry, block, 0);
+    return block & ((1u << geometry->indexBits) - 1);
+}
+
+unsigned int getOffsetBits(const Geometry* geometry, uint64_t address)
+{
+    return address & (geometry->blockSize - 1);
+}
+
+/**
+ * @brief Test a way's bit in a set's bitmask.
+ * @param const uint64_t* mask The set's bitmask words.
+ * @param unsigned int way Way to test.
+ * @return int 1 if the bit is set, 0 otherwise.
+ */
+static inline int testWay(const uint64_t* mask, unsigned int way)
+{
+    return (mask[way >> 6] >> (way & 63)) & 1;
+}
+
+/**
+ * @brief Set a way's bit in a set's bitmask.
+ * @param uint64_t* mask The set's bitmask words.
+ * @param unsigned int way Way to set.
+ * @return void
+ */
+static inline void setWay(uint64_t* mask, unsigned int way)
+{
+    mask[way >> 6] |= (uint64_t)1 << (way & 63);
+}
+
+/**
+ * @brief Clear a way's bit in a set's bitmask.
+ * @param uint64_t* mask The set's bitmask words.
+ * @param unsigned int way Way to clear.
+ * @return void
+ */
+static inline void clearWay(uint64_t* mask, unsigned int way)
+{
+    mask[way >> 6] &= ~((uint64_t)1 << (way & 63));
+}
+
+/**
+ * @brief Read a tag from an array of tags stored at a cache's tag width.
+ * @param const Cache* cache Cache the array belongs to.
+ * @param const void* tags The array of tags.
+ * @param size_t way Position of the tag in the array.
+ * @return uint64_t The tag.
+ */
+static inline uint64_t loadTag(const Cache* cache, const void* tags, size_t way)
+{
+    if(cache->tagBytes == 2)
+        return ((const uint16_t*)tags)[way];
+    if(cache->tagBytes == 4)
+        return ((const uint32_t*)tags)[way];
+    return ((const uint64_t*)tags)[way];
+}
+
+/**
+ * @brief Write a tag to an array of tags stored at a cache's tag width.
+ * @param const Cache* cache Cache the array belongs to.
+ * @param void* tags The array of tags.
+ * @param size_t way Position of the tag in the array.
+ * @param uint64_t tag The tag, which fits the cache's tag bits.
+ * @return void
+ */
+static inline void storeTag(const Cache* cache, void* tags, size_t way, uint64_t tag)
+{
+    if(cache->tagBytes == 2)
+        ((uint16_t*)tags)[way] = (uint16_t)tag;
+    else if(cache->tagBytes == 4)
+        ((uint32_t*)tags)[way] = (uint32_t)tag;
+    else
+        ((uint64_t*)tags)[way] = tag;
+}
+
+/**
+ * @brief Find the way of a set holding a tag. Inlined everywhere, so a constant associativity fixes the loop bounds.
+ * @param const Cache* cache Cache to search.
+ * @param unsigned int index Set to search.
+ * @param uint64_t tag Tag to find.
+ * @param unsigned int associativity The cache's associativity.
+ * @return int Way holding the tag, -1 if none does.
+ */
+static inline __attribute__((always_inline)) int findWayIn(const Cache* cache, unsigned int index, uint64_t tag, unsigned int associativity)
+{
+    size_t base = (size_t)index * associativity;
+    const uint64_t* valid = &cache->valid[(size_t)index * cache->maskWords];
+    unsigned int way = 0;
+
+    // Compare Groups of Ways, Groups Never Straddle a Bitmask Word
+    if(cache->tagBytes == 4)
+    {
+        const uint32_t* tags = (const uint32_t*)cache->tags + base;
+#if defined(__AVX2__)
+        __m256i needle8 = _mm256_set1_epi32((int)tag);
+        for(; way + 8 <= associativity; way += 8)
+        {
+            __m256i group = _mm256_loadu_si256((const __m256i*)&tags[way]);
+            unsigned int match = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(group, needle8)));
+            match &= (valid[way >> 6] >> (way & 63)) & 0xFF;
+            if(match)
+                return way + __builtin_ctz(match);
+        }
+#endif
+#if defined(__SSE2__)
+        __m128i needle4 = _mm_set1_epi32((int)tag);
+        for(; way + 4 <= associativity; way += 4)
+        {
+            __m128i group = _mm_loadu_si128((const __m128i*)&tags[way]);
+            unsigned int match = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(group, needle4)));
+            match &= (valid[way >> 6] >> (way & 63)) & 0xF;
+            if(match)
+                return way + __builtin_ctz(match);
+        }
+#endif
+        for(; way < associativity; way++)
+        {
+            if(tags[way] == tag && testWay(valid, way))
+                return way;
+        }
+        return -1;
+    }
+
+#if defined(__SSE2__)
+    if(cache->tagBytes == 2)
+    {
+        // Narrow the Comparisons to One Byte per Way, Eight Ways (or the Low Four) to a Register
+        const uint16_t* tags = (const uint16_t*)cache->tags + base;
+        __m128i needle8 = _mm_set1_epi16((short)tag);
+        for(; way + 8 <= associativity; way += 8)
+        {
+            __m128i equal = _mm_cmpeq_epi16(_mm_loadu_si128((const __m128i*)&tags[way]), needle8);
+            unsigned int match = _mm_movemask_epi8(_mm_packs_epi16(equal, equal)) & 0xFF;
+            match &= (valid[way >> 6] >> (way & 63)) & 0xFF;
+            if(match)
+                return way + __builtin_ctz(match);
+        }
+        for(; way + 4 <= associativity; way += 4)
+        {
+            __m128i equal = _mm_cmpeq_epi16(_mm_loadl_epi64((const __m128i*)&tags[way]), needle8);
+            unsigned int match = _mm_movemask_epi8(_mm_packs_epi16(equal, equal)) & 0xF;
+            match &= (valid[way >> 6] >> (way & 63)) & 0xF;
+            if(match)
+                return way + __builtin_ctz(match);
+        }
+    }
+#endif
+    for(; way < associativity; way++)
+    {
+        if(loadTag(cache, cache->tags, base + way) == tag && testWay(valid, way))
+            return way;
+    }
+    return -1;
+}
+
+int findWay(const Cache* cache, unsigned int index, uint64_t tag)
+{
+    return findWayIn(cache, index, tag, cache->geometry.associativity);
+}
+
+/**
+ * @brief Find an empty way of a set. Inlined everywhere, so a constant associativity fixes the loop bounds.
+ * @param const Cache* cache Cache to search.
+ * @param unsigned int index Set to search.
+ * @param unsigned int associativity The cache's associativity.
+ * @return int Lowest empty way, -1 if the set is full.
+ */
+static inline __attribute__((always_inline)) int findFreeWayIn(const Cache* cache, unsigned int index, unsigned int associativity)
+{
+    unsigned int words = (associativity + 63) / 64;
+    const uint64_t* valid = &cache->valid[(size_t)index * words];
+    unsigned int word;
+    for(word = 0; word < words; word++)
+    {
+        uint64_t invalid = ~valid[word];
+        if(invalid)
+        {
+            unsigned int way = word * 64 + __builtin_ctzll(invalid);
+            return way < associativity ? (int)way : -1;
+        }
+    }
+    return -1;
+}
+
+int findFreeWay(const Cache* cache, unsigned int index)
+{
+    return findFreeWayIn(cache, index, cache->geometry.associativity);
+}
+
+// ------- Replacement Policies ------- //
+// LRU: Doubly Linked Recency List of Ways (Head is Most Recent), O(1) Update and Victim
+static unsigned int lruStateBytes(unsigned int associativity)
+{
+    return sizeof(uint16_t) * (2 + 2 * associativity);
+}
+
+static void lruInit(unsigned char* state, unsigned int associativity, unsigned int index)
+{
+    (void)index;
+    uint16_t* list = (uint16_t*)state;
+    unsigned int i;
+    for(i = 0; i < 2 + 2 * associativity; i++)
+        list[i] = NO_WAY;
+}
+
+/**
+ * @brief Move a way to the head of an LRU recency list, linking it in if it is not already listed.
+ * @param unsigned char* state The set's recency list: head, tail, previous links, next links.
+ * @param unsigned int associativity Ways per set.
+ * @param unsigned int way Way to move.
+ * @return void
+ */
+static void lruTouch(unsigned char* state, unsigned int associativity, unsigned int way)
+{
+    uint16_t* head = (uint16_t*)state;
+    uint16_t* tail = head + 1;
+    uint16_t* prev = head + 2;
+    uint16_t* next = prev + associativity;
+    if(*head == way)
+        return;
+
+    // Unlink (a Listed Way Other Than the Head Always Has a Previous Way)
+    if(prev[way] != NO_WAY)
+    {
+        next[prev[way]] = next[way];
+        if(next[way] != NO_WAY)
+            prev[next[way]] = prev[way];
+        else
+            *tail = prev[way];
+    }
+
+    // Push Front
+    prev[way] = NO_WAY;
+    next[way] = *head;
+    if(*head != NO_WAY)
+        prev[*head] = way;
+    else
+        *tail = way;
+    *head = way;
+}
+
+static unsigned int lruVictim(unsigned char* state, unsigned int associativity)
+{
+    (void)associativity;
+    return ((uint16_t*)state)[1];
+}
+
+// Tree-PLRU: One Bit per Internal Node of a Binary Tree Over the Ways, Each Pointing Toward the Victim
+static unsigned int plruStateBytes(unsigned int associativity)
+{
+    return sizeof(uint64_t) * ((associativity + 63) / 64);
+}
+
+static void plruInit(unsigned char* state, unsigned int associativity, unsigned int index)
+{
+    (void)state;
+    (void)associativity;
+    (void)index;
+}
+
+static void plruTouch(unsigned char* state, unsigned int associativity, unsigned int way)
+{
+    uint64_t* bits = (uint64_t*)state;
+    unsigned int node = 1;
+    unsigned int half;
+    for(half = associativity / 2; half > 0; half /= 2)
+    {
+        // Point the Node Away From the Accessed Half
+        unsigned int right = (way & half) != 0;
+        if(right)
+            clearWay(bits, node);
+        else
+            setWay(bits, node);
+        node = node * 2 + right;
+    }
+}
+
+static unsigned int plruVictim(unsigned char* state, unsigned int associativity)
+{
+    uint64_t* bits = (uint64_t*)state;
+    unsigned int node = 1;
+    while(node < associativity)
+        node = node * 2 + testWay(bits, node);
+    return node - associativity;
+}
+
+// SRRIP/BRRIP: 2 Bit Re-Reference Prediction Values, 32 Ways per Word, Followed by a Fill Counter
+#define RRPV_LANES 0x5555555555555555ULL
+
+static unsigned int rripStateBytes(unsigned int associativity)
+{
+    return sizeof(uint64_t) * ((associativity + 31) / 32 + 1);
+}
+
+static void rripInit(unsigned char* state, unsigned int associativity, unsigned int index)
+{
+    (void)state;
+    (void)associativity;
+    (void)index;
+}
+
+/**
+ * @brief Set a way's re-reference prediction value.
+ * @param unsigned char* state The set's packed prediction values.
+ * @param unsigned int way Way to set.
+ * @param unsigned int rrpv Value to set, 0 (imminent) to 3 (distant).
+ * @return void
+ */
+static void rripSet(unsigned char* state, unsigned int way, unsigned int rrpv)
+{
+    uint64_t* words = (uint64_t*)state;
+    unsigned int shift = (way & 31) * 2;
+    words[way >> 5] = (words[way >> 5] & ~(3ULL << shift)) | ((uint64_t)rrpv << shift);
+}
+
+static void rripTouch(unsigned char* state, unsigned int associativity, unsigned int way)
+{
+    (void)associativity;
+    rripSet(state, way, 0);
+}
+
+static void srripFill(unsigned char* state, unsigned int associativity, unsigned int way)
+{
+    (void)associativity;
+    rripSet(state, way, 2);
+}
+
+static void brripFill(unsigned char* state, unsigned int associativity, unsigned int way)
+{
+    // Insert Distant, and Long Every BRRIP_LONG_INTERVAL Fills
+    uint64_t* fills = &((uint64_t*)state)[(associativity + 31) / 32];
+    *fills += 1;
+    rripSet(state, way, (*fills % BRRIP_LONG_INTERVAL == 0) ? 2 : 3);
+}
+
+static unsigned int rripVictim(unsigned char* state, unsigned int associativity)
+{
+    uint64_t* words = (uint64_t*)state;
+    unsigned int count = (associativity + 31) / 32;
+    while(1)
+    {
+        // First Way Predicted Distant (Both Bits Set)
+        unsigned int w;
+        for(w = 0; w < count; w++)
+        {
+            unsigned int lanes = associativity - w * 32;
+            uint64_t mask = lanes >= 32 ? RRPV_LANES : RRPV_LANES & ((1ULL << (lanes * 2)) - 1);
+            uint64_t distant = words[w] & (words[w] >> 1) & mask;
+            if(distant)
+                return w * 32 + __builtin_ctzll(distant) / 2;
+        }
+
+        // None, Age Every Way at Once (No Lane Can Carry Since None is 3)
+        for(w = 0; w < count; w++)
+        {
+            unsigned int lanes = associativity - w * 32;
+            words[w] += lanes >= 32 ? RRPV_LANES : RRPV_LANES & ((1ULL << (lanes * 2)) - 1);
+        }
+    }
+}
+
+// FIFO: Next Way to Replace, Advanced on Each Fill
+static unsigned int fifoStateBytes(unsigned int associativity)
+{
+    (void)associativity;
+    return sizeof(uint32_t);
+}
+
+static void fifoInit(unsigned char* state, unsigned int associativity, unsigned int index)
+{
+    (void)state;
+    (void)associativity;
+    (void)index;
+}
+
+static void fifoTouch(unsigned char* state, unsigned int associativity, unsigned int way)
+{
+    (void)state;
+    (void)associativity;
+    (void)way;
+}
+
+static void fifoFill(unsigned char* state, unsigned int associativity, unsigned int way)
+{
+    uint32_t* next = (uint32_t*)state;
+    if(*next == way)
+        *next = (way + 1) % associativity;
+}
+
+static unsigned int fifoVictim(unsigned char* state, unsigned int associativity)
+{
+    (void)associativity;
+    return *(uint32_t*)state;
+}
+
+// Random: Per Set Xorshift Generator, so Results Do Not Depend on How Sets are Sharded
+static unsigned int randomStateBytes(unsigned int associativity)
+{
+    (void)associativity;
+    return sizeof(uint32_t);
+}
+
+static void randomInit(unsigned char* state, unsigned int associativity, unsigned int index)
+{
+    (void)associativity;
+    *(uint32_t*)state = index * 2654435761u + 1;
+    if(*(uint32_t*)state == 0)
+        *(uint32_t*)state = 1;
+}
+
+static void randomTouch(unsigned char* state, unsigned int associativity, unsigned int way)
+{
+    (void)state;
+    (void)associativity;
+    (void)way;
+}
+
+static unsigned int randomVictim(unsigned char* state, unsigned int associativity)
+{
+    uint32_t* x = (uint32_t*)state;
+    *x ^= *x << 13;
+    *x ^= *x >> 17;
+    *x ^= *x << 5;
+    return *x % associativity;
+}
+
+// NRU: One Referenced Bit per Way, Cleared When Every Way Has Been Referenced
+static unsigned int nruStateBytes(unsigned int associativity)
+{
+    return sizeof(uint64_t) * ((associativity + 63) / 64);
+}
+
+static void nruInit(unsigned char* state, unsigned int associativity, unsigned int index)
+{
+    (void)state;
+    (void)associativity;
+    (void)index;
+}
+
+static void nruTouch(unsigned char* state, unsigned int associativity, unsigned int way)
+{
+    uint64_t* bits = (uint64_t*)state;
+    unsigned int words = (associativity + 63) / 64;
+    setWay(bits, way);
+
+    unsigned int w;
+    for(w = 0; w < words; w++)
+    {
+        unsigned int lanes = associativity - w * 64;
+        uint64_t mask = lanes >= 64 ? ~0ULL : (1ULL << lanes) - 1;
+        if((bits[w] & mask) != mask)
+            return;
+    }
+    memset(bits, 0, sizeof(uint64_t) * words);
+    setWay(bits, way);
+}
+
+static unsigned int nruVictim(unsigned char* state, unsigned int associativity)
+{
+    uint64_t* bits = (uint64_t*)state;
+    unsigned int w;
+    for(w = 0; w < (associativity + 63) / 64; w++)
+    {
+        if(~bits[w])
+        {
+            unsigned int way = w * 64 + __builtin_ctzll(~bits[w]);
+            return way < associativity ? way : 0;
+        }
+    }
+    return 0;
+}
+
+INTERNAL const ReplacementPolicy REPLACEMENT_POLICIES[MAX_REPLACEMENT_POLICIES] =
+{
+    {"lru", "LRU", 0, lruStateBytes, lruInit, lruTouch, lruTouch, lruVictim},
+    {"plru", "Tree-PLRU", 1, plruStateBytes, plruInit, plruTouch, plruTouch, plruVictim},
+    {"srrip", "SRRIP", 0, rripStateBytes, rripInit, rripTouch, srripFill, rripVictim},
+    {"brrip", "BRRIP", 0, rripStateBytes, rripInit, rripTouch, brripFill, rripVictim},
+    {"fifo", "FIFO", 0, fifoStateBytes, fifoInit, fifoTouch, fifoFill, fifoVictim},
+    {"random", "Random", 0, randomStateBytes, randomInit, randomTouch, randomTouch, randomVictim},
+    {"nru", "NRU", 0, nruStateBytes, nruInit, nruTouch, nruTouch, nruVictim}
+};
+
+// ------------ DRAM Model ------------ //
+/**
+ * @brief Pick the request the DRAM controller serves next, first ready, first come first served.
+ * @param const Dram* dram DRAM with at least one waiting request.
+ * @param unsigned long* start Destination of the cycle the request can start, once its bank and the controller are free.
+ * @return unsigned int Position of the request in the queue.
+ */
+static unsigned int pickDramRequest(const Dram* dram, unsigned long* start)
+{
+    // The Requests Able to Start Soonest Go First, Row Hits Among Them Ahead of Older Misses
+    unsigned int pick = 0;
+    int pickHit = 0;
+    unsigned int i;
+    for(i = 0; i < dram->size; i++)
+    {
+        const DramRequest* request = &dram->queue[i];
+        unsigned long ready = dram->readyAt[request->bank];
+        if(ready < dram->clock)
+            ready = dram->clock;
+        if(ready < request->arrival)
+            ready = request->arrival;
+        int hit = (dram->openRows[request->bank] == request->row);
+        if(i == 0 || ready < *start || (ready == *start && hit && !pickHit))
+        {
+            pick = i;
+            *start = ready;
+            pickHit = hit;
+        }
+    }
+    return pick;
+}
+
+/**
+ * @brief Serve a queued request: open its row (closing the bank's open row first on a conflict), move its burst over
+ *        the shared data bus, then leave the row open or precharge the bank by the page policy.
+ * @param Dram* dram DRAM serving the request.
+ * @param unsigned int pick Position of the request in the queue.
+ * @param unsigned long start Cycle the request starts.
+ * @return void
+ */
+static void serveDramRequest(Dram* dram, unsigned int pick, unsigned long start)
+{
+    DramRequest request = dram->queue[pick];
+    memmove(&dram->queue[pick], &dram->queue[pick + 1], sizeof(DramRequest) * (dram->size - pick - 1));
+    dram->size -= 1;
+
+    unsigned long access = DRAM_CAS;
+    if(dram->openRows[request.bank] == request.row)
+        dram->rowHits += 1;
+    else if(dram->openRows[request.bank] == NO_ROW)
+    {
+        dram->rowMisses += 1;
+        access += DRAM_RCD;
+    }
+    else
+    {
+        dram->conflicts += 1;
+        access += DRAM_RP + DRAM_RCD;
+    }
+
+    // Bursts Take Turns on the Bus, and an Open Row Takes Its Next Column Access Once the Burst Starts
+    unsigned long burst = start + access;
+    if(burst < dram->busFree)
+        burst = dram->busFree;
+    unsigned long done = burst + DRAM_BURST;
+    dram->busFree = done;
+    dram->clock = start + 1;
+    if(dram->config.page == 'o')
+    {
+        dram->openRows[request.bank] = request.row;
+        dram->readyAt[request.bank] = burst;
+    }
+    else
+    {
+        dram->openRows[request.bank] = NO_ROW;
+        dram->readyAt[request.bank] = done + DRAM_RP;
+    }
+
+    dram->requests += 1;
+    dram->writes += request.write;
+    dram->latency += done - request.arrival;
+}
+
+/**
+ * @brief Queue a request at the DRAM controller, first serving whatever could start before it arrives. A full queue
+ *        stalls the cache until a request leaves it, delaying this request and every later one.
+ * @param Dram* dram DRAM to request from.
+ * @param uint64_t address Address requested.
+ * @param char write Indicates a writeback or written through word.
+ * @param unsigned long issued Cycle the cache issues the request had it never stalled, no earlier than any before it.
+ * @return void
+ */
+static void queueDramRequest(Dram* dram, uint64_t address, char write, unsigned long issued)
+{
+    issued += dram->delay;
+    unsigned long arrival = issued;
+    while(dram->size)
+    {
+        unsigned long start;
+        unsigned int pick = pickDramRequest(dram, &start);
+        if(start >= arrival && dram->size < dram->config.depth)
+            break;
+        if(start > arrival)
+            arrival = start;
+        serveDramRequest(dram, pick, start);
+    }
+    dram->delay += arrival - issued;
+    dram->stalls += arrival - issued;
+    dram->latency += arrival - issued;
+
+    // Consecutive Rows Interleave Across the Banks
+    uint64_t row = address / dram->config.rowBytes;
+    DramRequest* request = &dram->queue[dram->size++];
+    request->bank = row % dram->config.banks;
+    request->row = row / dram->config.banks;
+    request->arrival = arrival;
+    request->write = write;
+}
+
+void drainDram(Dram* dram)
+{
+    while(dram->size)
+    {
+        unsigned long start;
+        unsigned int pick = pickDramRequest(dram, &start);
+        serveDramRequest(dram, pick, start);
+    }
+}
+
+/**
+ * @brief Count a memory reference of a cache, sending it to the cache's DRAM if one is attached.
+ * @param Cache* cache Cache referencing memory.
+ * @param uint64_t address Address of the block fetched or written back, or of the word written through.
+ * @param char write Indicates a writeback or written through word.
+ * @return void
+ */
+static inline void referenceMemory(Cache* cache, uint64_t address, char write)
+{
+    cache->memrefs += 1;
+    if(cache->dram)
+        queueDramRequest(cache->dram, address, write, (cache->dram->elapsed + cache->cacheReferences) * cache->dram->config.gap);
+}
+
+// ------------ Prefetchers ------------ //
+// Next-Line: Fetch the Following Block on Each Miss (or First Use of a Prefetched Block)
+static unsigned int nextLinePredict(unsigned char* state, uint64_t block, int miss, uint64_t* blocks)
+{
+    (void)state;
+    if(!miss)
+        return 0;
+    blocks[0] = block + 1;
+    return 1;
+}
+
+/**
+ * @brief Follow the stream nearest a block, prefetching ahead once the same stride repeats.
+ * @param unsigned char* state StrideState of the prefetcher.
+ * @param uint64_t block Block being accessed.
+ * @param int miss Indicates the access missed (or first used a prefetched block).
+ * @param uint64_t* blocks Destination of the blocks to prefetch.
+ * @return unsigned int Number of blocks to prefetch.
+ */
+static unsigned int stridePredict(unsigned char* state, uint64_t block, int miss, uint64_t* blocks)
+{
+    (void)miss;
+    StrideState* stride = (StrideState*)state;
+    stride->clock += 1;
+
+    // Match a Stream Within the Window, or Replace the Least Recently Used One
+    Stream* match = NULL;
+    Stream* oldest = &stride->streams[0];
+    int i;
+    for(i = 0; i < STRIDE_STREAMS; i++)
+    {
+        Stream* stream = &stride->streams[i];
+        int64_t distance = (int64_t)(block - stream->last);
+        if(!match && stream->used && distance >= -STRIDE_WINDOW && distance <= STRIDE_WINDOW)
+            match = stream;
+        if(stream->used < oldest->used)
+            oldest = stream;
+    }
+    if(!match)
+    {
+        oldest->last = block;
+        oldest->stride = 0;
+        oldest->confidence = 0;
+        oldest->used = stride->clock;
+        return 0;
+    }
+
+    match->used = stride->clock;
+    int distance = (int)(block - match->last);
+    if(distance == 0)
+        return 0;
+    if(distance == match->stride)
+        match->confidence += (match->confidence < 3);
+    else
+    {
+        match->stride = distance;
+        match->confidence = 0;
+    }
+    match->last = block;
+    if(match->confidence == 0)
+        return 0;
+
+    for(i = 0; i < STRIDE_DEGREE; i++)
+        blocks[i] = block + distance * (i + 1);
+    return STRIDE_DEGREE;
+}
+
+/**
+ * @brief Find the last two miss deltas earlier in the history, and replay the deltas that followed them.
+ * @param unsigned char* state DeltaState of the prefetcher.
+ * @param uint64_t block Block being accessed.
+ * @param int miss Indicates the access missed (or first used a prefetched block).
+ * @param uint64_t* blocks Destination of the blocks to prefetch.
+ * @return unsigned int Number of blocks to prefetch.
+ */
+static unsigned int deltaPredict(unsigned char* state, uint64_t block, int miss, uint64_t* blocks)
+{
+    DeltaState* delta = (DeltaState*)state;
+    if(!miss)
+        return 0;
+    if(delta->count++ == 0)
+    {
+        delta->last = block;
+        return 0;
+    }
+
+    // Deltas 1 Through n Are Known, Only the Last DELTA_HISTORY Are Kept
+    unsigned long n = delta->count - 1;
+    delta->deltas[n % DELTA_HISTORY] = (int)(block - delta->last);
+    delta->last = block;
+    if(n < 3)
+        return 0;
+
+    int first = delta->deltas[(n - 1) % DELTA_HISTORY];
+    int second = delta->deltas[n % DELTA_HISTORY];
+    unsigned long oldest = (n > DELTA_HISTORY) ? n - DELTA_HISTORY + 1 : 1;
+    unsigned long j;
+    for(j = n - 1; j > oldest; j--)
+    {
+        if(delta->deltas[(j - 1) % DELTA_HISTORY] != first || delta->deltas[j % DELTA_HISTORY] != second)
+            continue;
+
+        unsigned int count = 0;
+        uint64_t next = block;
+        unsigned long k;
+        for(k = j + 1; k <= n && count < MAX_PREFETCH_DEGREE; k++)
+        {
+            next += delta->deltas[k % DELTA_HISTORY];
+            blocks[count++] = next;
+        }
+        return count;
+    }
+    return 0;
+}
+
+INTERNAL const Prefetcher PREFETCHERS[MAX_PREFETCHERS] =
+{
+    {"next", "Next-Line", 0, nextLinePredict},
+    {"stride", "Stride", sizeof(StrideState), stridePredict},
+    {"delta", "Delta Correlation", sizeof(DeltaState), deltaPredict}
+};
+
+const Prefetcher* findPrefetcher(const char* name)
+{
+    int i;
+    for(i = 0; i < MAX_PREFETCHERS; i++)
+    {
+        if(strcmp(PREFETCHERS[i].name, name) == 0)
+            return &PREFETCHERS[i];
+    }
+    return NULL;
+}
+
+/**
+ * @brief Place a block in a victim or miss cache, replacing its least recently used entry.
+ * @param VictimCache* victims Buffer to place into.
+ * @param uint64_t block Block address to place.
+ * @return void
+ */
+static void insertVictim(VictimCache* victims, uint64_t block)
+{
+    unsigned int oldest = 0;
+    unsigned int i;
+    for(i = 1; i < victims->entries; i++)
+    {
+        if(victims->used[i] < victims->used[oldest])
+            oldest = i;
+    }
+    victims->blocks[oldest] = block;
+    victims->used[oldest] = ++victims->clock;
+}
+
+/**
+ * @brief Probe a cache's victim or miss cache for a block the cache missed. A victim cache hands the block
+ *        back to the cache, a miss cache keeps its copy and records the block if it was absent.
+ * @param VictimCache* victims Buffer to probe.
+ * @param uint64_t block Block address the cache missed.
+ * @return int 1 if the buffer supplies the block, 0 if memory must.
+ */
+static int probeVictims(VictimCache* victims, uint64_t block)
+{
+    unsigned int i;
+    for(i = 0; i < victims->entries; i++)
+    {
+        if(!victims->used[i] || victims->blocks[i] != block)
+            continue;
+
+        victims->hits += 1;
+        if(victims->kind == 'm')
+            victims->used[i] = ++victims->clock;
+        else
+            victims->used[i] = 0;
+        return 1;
+    }
+
+    if(victims->kind == 'm')
+        insertVictim(victims, block);
+    return 0;
+}
+
+/**
+ * @brief Block number held by a way, undoing the index function on the stored tag.
+ * @param const Cache* cache Cache holding the block.
+ * @param unsigned int index Set of the way.
+ * @param unsigned int way Way holding the block.
+ * @return uint64_t The block number.
+ */
+static uint64_t blockOfWay(const Cache* cache, unsigned int index, unsigned int way)
+{
+    const Geometry* geometry = &cache->geometry;
+    uint64_t tag = loadTag(cache, cache->tags, (size_t)index * geometry->associativity + way);
+    if(geometry->indexing == 'p')
+        return tag * geometry->modulus + index;
+    if(geometry->indexing)
+        index ^= hashTag(geometry, tag, way);
+    return (tag << geometry->indexBits) | index;
+}
+
+/**
+ * @brief Evict the block in a way, writing it back if dirty and keeping it in the victim cache if one is attached.
+ * @param Cache* cache Cache to evict from.
+ * @param unsigned int index Set of the way.
+ * @param int way Way to evict.
+ * @return void
+ */
+static void retireBlock(Cache* cache, unsigned int index, int way)
+{
+    uint64_t* dirty = &cache->dirty[(size_t)index * cache->maskWords];
+    if(testWay(dirty, way))
+    {
+        referenceMemory(cache, blockOfWay(cache, index, way) << cache->geometry.offsetBits, 1);
+        cache->writebacks += 1;
+    }
+    clearWay(dirty, way);
+
+    if(cache->victims && cache->victims->kind == 'v')
+        insertVictim(cache->victims, blockOfWay(cache, index, way));
+}
+
+/**
+ * @brief Fill a block ahead of demand unless it is already cached, remembering the block it evicts.
+ * @param Cache* cache Cache to fill.
+ * @param uint64_t address Any address within the block, wrapped to the cache's address bits.
+ * @return void
+ */
+static void prefetchBlock(Cache* cache, uint64_t address)
+{
+    address &= getAddressMask(cache->geometry.addressBits);
+    unsigned int index = getIndexBits(&cache->geometry, address);
+    uint64_t tag = getTagBits(&cache->geometry, address);
+    if(findWay(cache, index, tag) > -1)
+        return;
+
+    size_t base = (size_t)index * cache->geometry.associativity;
+    size_t mask = (size_t)index * cache->maskWords;
+    unsigned char* state = &cache->state[(size_t)index * cache->stateBytes];
+    cache->prefetches += 1;
+    referenceMemory(cache, (address >> cache->geometry.offsetBits) << cache->geometry.offsetBits, 0);
+    cache->fetches += 1;
+
+    int fill = findFreeWay(cache, index);
+    if(fill < 0)
+    {
+        fill = cache->replacement->victim(state, cache->geometry.associativity);
+        retireBlock(cache, index, fill);
+        storeTag(cache, cache->pollutedTags, base + fill, loadTag(cache, cache->tags, base + fill));
+        setWay(&cache->polluted[mask], fill);
+    }
+
+    storeTag(cache, cache->tags, base + fill, tag);
+    setWay(&cache->valid[mask], fill);
+    setWay(&cache->prefetched[mask], fill);
+    cache->replacement->fill(state, cache->geometry.associativity, fill);
+}
+
+/**
+ * @brief Account for a demand access in the prefetch counters, then train the prefetcher and issue its predictions.
+ * @param Cache* cache Cache being accessed.
+ * @param uint64_t address Address accessed.
+ * @param unsigned int index Set of the address.
+ * @param uint64_t tag Tag of the address.
+ * @param int hit Way that hit before the access, -1 on a miss.
+ * @return void
+ */
+static void trainPrefetcher(Cache* cache, uint64_t address, unsigned int index, uint64_t tag, int hit)
+{
+    size_t mask = (size_t)index * cache->maskWords;
+    int miss = (hit < 0);
+    if(!miss && testWay(&cache->prefetched[mask], hit))
+    {
+        // First Use of a Prefetched Block, a Miss the Prefetcher Covered
+        clearWay(&cache->prefetched[mask], hit);
+        cache->usefulPrefetches += 1;
+        miss = 1;
+    }
+    else if(miss)
+    {
+        // A Miss on a Block a Prefetch Evicted is Pollution
+        size_t base = (size_t)index * cache->geometry.associativity;
+        unsigned int word;
+        for(word = 0; word < cache->maskWords; word++)
+        {
+            uint64_t ways = cache->polluted[mask + word];
+            while(ways)
+            {
+                unsigned int way = word * 64 + __builtin_ctzll(ways);
+                if(loadTag(cache, cache->pollutedTags, base + way) == tag)
+                {
+                    clearWay(&cache->polluted[mask], way);
+                    cache->pollution += 1;
+                }
+                ways &= ways - 1;
+            }
+        }
+
+        // The Demand Fill (if Any) Replaced Whatever the Way Held
+        int way = findWay(cache, index, tag);
+        if(way > -1)
+            clearWay(&cache->prefetched[mask], way);
+    }
+
+    uint64_t blocks[MAX_PREFETCH_DEGREE];
+    unsigned int count = cache->prefetcher->predict(cache->prefetchState, address >> cache->geometry.offsetBits, miss, blocks);
+    unsigned int i;
+    for(i = 0; i < count; i++)
+        prefetchBlock(cache, blocks[i] << cache->geometry.offsetBits);
+}
+
+// ------- Miss Classification ------- //
+/**
+ * @brief Hash a block address into an open addressed table.
+ * @param uint64_t block Block address, folded to 32 bits before hashing.
+ * @param unsigned int mask Table slots minus one.
+ * @return unsigned int Home slot of the block.
+ */
+static inline unsigned int hashBlock(uint64_t block, unsigned int mask)
+{
+    return ((unsigned int)(block ^ (block >> 32)) * 2654435761u) & mask;
+}
+
+/**
+ * @brief Add a block to the set of fetched blocks, doubling the set once it is half full.
+ * @param Classifier* classifier Classifier to update.
+ * @param uint64_t block Block address.
+ * @return int 1 if the block is new, 0 if it was fetched before.
+ */
+static int markSeen(Classifier* classifier, uint64_t block)
+{
+    unsigned int slot = hashBlock(block, classifier->seenMask);
+    while(classifier->seen[slot] != NO_ADDRESS)
+    {
+        if(classifier->seen[slot] == block)
+            return 0;
+        slot = (slot + 1) & classifier->seenMask;
+    }
+    classifier->seen[slot] = block;
+    classifier->seenCount += 1;
+
+    if(classifier->seenCount * 2 > classifier->seenMask)
+    {
+        uint64_t* old = classifier->seen;
+        unsigned int slots = classifier->seenMask + 1;
+        classifier->seenMask = slots * 2 - 1;
+        classifier->seen = (uint64_t*)malloc(sizeof(uint64_t) * slots * 2);
+        memset(classifier->seen, 0xFF, sizeof(uint64_t) * slots * 2);
+        unsigned int i;
+        for(i = 0; i < slots; i++)
+        {
+            if(old[i] == NO_ADDRESS)
+                continue;
+            slot = hashBlock(old[i], classifier->seenMask);
+            while(classifier->seen[slot] != NO_ADDRESS)
+                slot = (slot + 1) & classifier->seenMask;
+            classifier->seen[slot] = old[i];
+        }
+        free(old);
+    }
+    return 1;
+}
+
+/**
+ * @brief Check whether a block has been fetched before, without adding it.
+ * @param const Classifier* classifier Classifier to search.
+ * @param uint64_t block Block address.
+ * @return int 1 if the block was fetched before, 0 otherwise.
+ */
+static int wasSeen(const Classifier* classifier, uint64_t block)
+{
+    unsigned int slot = hashBlock(block, classifier->seenMask);
+    while(classifier->seen[slot] != NO_ADDRESS)
+    {
+        if(classifier->seen[slot] == block)
+            return 1;
+        slot = (slot + 1) & classifier->seenMask;
+    }
+    return 0;
+}
+
+/**
+ * @brief Find the map slot of a block in the shadow, or the empty slot it would take.
+ * @param const Classifier* classifier Classifier to search.
+ * @param uint64_t block Block address.
+ * @return unsigned int Slot holding the block's node, or the first empty slot of its probe sequence.
+ */
+static unsigned int findShadowSlot(const Classifier* classifier, uint64_t block)
+{
+    unsigned int slot = hashBlock(block, classifier->nodeMask);
+    while(classifier->nodes[slot] != NO_BLOCK && classifier->blocks[classifier->nodes[slot]] != block)
+        slot = (slot + 1) & classifier->nodeMask;
+    return slot;
+}
+
+/**
+ * @brief Remove a slot from the shadow's map, shifting later entries of the probe sequence back into the hole.
+ * @param Classifier* classifier Classifier to update.
+ * @param unsigned int hole Slot to empty.
+ * @return void
+ */
+static void removeShadowSlot(Classifier* classifier, unsigned int hole)
+{
+    unsigned int slot = hole;
+    while(1)
+    {
+        slot = (slot + 1) & classifier->nodeMask;
+        if(classifier->nodes[slot] == NO_BLOCK)
+            break;
+
+        // Move the Entry Back Unless its Home Lies Cyclically in (hole, slot]
+        unsigned int home = hashBlock(classifier->blocks[classifier->nodes[slot]], classifier->nodeMask);
+        if(((slot - home) & classifier->nodeMask) >= ((slot - hole) & classifier->nodeMask))
+        {
+            classifier->nodes[hole] = classifier->nodes[slot];
+            hole = slot;
+        }
+    }
+    classifier->nodes[hole] = NO_BLOCK;
+}
+
+/**
+ * @brief Move a shadow node to the head of the LRU list, linking it in if it is not listed.
+ * @param Classifier* classifier Classifier to update.
+ * @param unsigned int node Node to move.
+ * @param int listed Indicates the node is already in the list.
+ * @return void
+ */
+static void touchShadowNode(Classifier* classifier, unsigned int node, int listed)
+{
+    if(listed)
+    {
+        if(classifier->head == node)
+            return;
+        classifier->next[classifier->prev[node]] = classifier->next[node];
+        if(classifier->next[node] != NO_BLOCK)
+            classifier->prev[classifier->next[node]] = classifier->prev[node];
+        else
+            classifier->tail = classifier->prev[node];
+    }
+
+    classifier->prev[node] = NO_BLOCK;
+    classifier->next[node] = classifier->head;
+    if(classifier->head != NO_BLOCK)
+        classifier->prev[classifier->head] = node;
+    else
+        classifier->tail = node;
+    classifier->head = node;
+}
+
+/**
+ * @brief Access the fully associative shadow, mirroring the cache's updates.
+ * @param Classifier* classifier Classifier to access.
+ * @param uint64_t block Block address.
+ * @param int touch Indicates the access updates recency on a hit (reads and writes).
+ * @param int allocate Indicates the access fills the block on a miss.
+ * @return int 1 on a shadow hit, 0 on a shadow miss.
+ */
+static int shadowAccess(Classifier* classifier, uint64_t block, int touch, int allocate)
+{
+    unsigned int slot = findShadowSlot(classifier, block);
+    if(classifier->nodes[slot] != NO_BLOCK)
+    {
+        if(touch)
+            touchShadowNode(classifier, classifier->nodes[slot], 1);
+        return 1;
+    }
+    if(!allocate)
+        return 0;
+
+    // Reuse the Least Recently Used Node Once Full
+    unsigned int node;
+    if(classifier->size < classifier->capacity)
+    {
+        node = classifier->size++;
+    }
+    else
+    {
+        node = classifier->tail;
+        classifier->tail = classifier->prev[node];
+        classifier->next[classifier->tail] = NO_BLOCK;
+        removeShadowSlot(classifier, findShadowSlot(classifier, classifier->blocks[node]));
+        slot = findShadowSlot(classifier, block);
+    }
+    classifier->blocks[node] = block;
+    classifier->nodes[slot] = node;
+    touchShadowNode(classifier, node, 0);
+    return 0;
+}
+
+/**
+ * @brief Run an access through the classifier, counting the cache's miss (if any) as compulsory, capacity or conflict.
+ * @param Cache* cache Cache being accessed.
+ * @param Line* l Line being accessed.
+ * @param unsigned int index Set of the address.
+ * @param int hit Indicates the cache hit.
+ * @return void
+ */
+static void classifyAccess(Cache* cache, Line* l, unsigned int index, int hit)
+{
+    Classifier* classifier = cache->classifier;
+    uint64_t block = l->address >> cache->geometry.offsetBits;
+    int touch = (l->operation == 'R' || l->operation == 'W');
+    int allocate = (l->operation == 'R' || (l->operation == 'W' && cache->policy->writeAllocate));
+    int shadowHit = shadowAccess(classifier, block, touch, allocate);
+    int fresh = allocate ? markSeen(classifier, block) : !wasSeen(classifier, block);
+    if(hit)
+        return;
+
+    unsigned long* counts = &classifier->counts[(size_t)index * 3];
+    if(fresh)
+        counts[0] += 1;
+    else if(!shadowHit)
+        counts[1] += 1;
+    else
+        counts[2] += 1;
+}
+
+/**
+ * @brief Add a block to the blocks touched in the current interval. Slots stamped by earlier intervals count as empty.
+ * @param IntervalLog* intervals Time series to update.
+ * @param uint64_t block Block address.
+ * @return void
+ */
+static void touchIntervalBlock(IntervalLog* intervals, uint64_t block)
+{
+    unsigned int stamp = (unsigned int)intervals->count + 1;
+    unsigned int slot = hashBlock(block, intervals->mask);
+    while(intervals->stamps[slot] == stamp)
+    {
+        if(intervals->blocks[slot] == block)
+            return;
+        slot = (slot + 1) & intervals->mask;
+    }
+    intervals->blocks[slot] = block;
+    intervals->stamps[slot] = stamp;
+    intervals->unique += 1;
+
+    // Keep the Set at Most Half Full, Carrying Over Only the Current Interval's Blocks
+    if(intervals->unique * 2 > intervals->mask)
+    {
+        unsigned int oldMask = intervals->mask;
+        uint64_t* oldBlocks = intervals->blocks;
+        unsigned int* oldStamps = intervals->stamps;
+        intervals->mask = oldMask * 2 + 1;
+        intervals->blocks = (uint64_t*)malloc(sizeof(uint64_t) * (intervals->mask + 1));
+        intervals->stamps = (unsigned int*)calloc(intervals->mask + 1, sizeof(unsigned int));
+        unsigned int i;
+        for(i = 0; i <= oldMask; i++)
+        {
+            if(oldStamps[i] != stamp)
+                continue;
+            slot = hashBlock(oldBlocks[i], intervals->mask);
+            while(intervals->stamps[slot] == stamp)
+                slot = (slot + 1) & intervals->mask;
+            intervals->blocks[slot] = oldBlocks[i];
+            intervals->stamps[slot] = stamp;
+        }
+        free(oldBlocks);
+        free(oldStamps);
+    }
+}
+
+/**
+ * @brief Write the current interval's row and start the next one, clearing the cache's counters once the warmup ends.
+ * @param Cache* cache Cache with an interval time series attached.
+ * @return void
+ */
+static void closeInterval(Cache* cache)
+{
+    IntervalLog* intervals = cache->intervals;
+    unsigned long references = cache->cacheReferences - intervals->references;
+    unsigned long misses = cache->misses - intervals->misses;
+    fprintf(intervals->out, "%s,%lu,%lu,%lu,%.6f,%lu,%lu,%u\n", cache->policy->name, intervals->count, references, misses,
+            references ? (double)misses / references : 0.0, cache->writebacks - intervals->writebacks,
+            cache->memrefs - intervals->memrefs, intervals->unique);
+
+    intervals->count += 1;
+    intervals->unique = 0;
+    if(intervals->count == intervals->warmup)
+    {
+        clearCounters(cache);
+        return;
+    }
+    intervals->references = cache->cacheReferences;
+    intervals->misses = cache->misses;
+    intervals->writebacks = cache->writebacks;
+    intervals->memrefs = cache->memrefs;
+}
+
+void flushIntervalLog(Cache* cache)
+{
+    if(cache->cacheReferences > cache->intervals->references)
+        closeInterval(cache);
+}
+
+int replaceBlock(Cache* cache, unsigned int index, uint64_t tag)
+{
+    unsigned char* state = &cache->state[(size_t)index * cache->stateBytes];
+    int replacementSet = cache->replacement->victim(state, cache->geometry.associativity);
+
+    retireBlock(cache, index, replacementSet);
+    storeTag(cache, cache->tags, (size_t)index * cache->geometry.associativity + replacementSet, tag);
+    cache->replacement->fill(state, cache->geometry.associativity, replacementSet);
+    return replacementSet;
+}
+
+/**
+ * @brief Look up, fill and replace a line in a skewed cache, where each way indexes its own set, so the block's
+ *        candidates are one slot per way and the least recently used of them is replaced by its stamp.
+ * @param Cache* cache Skewed cache to simulate, its reference already counted.
+ * @param Line* l Line to cache.
+ * @return void
+ */
+static void skewedAccess(Cache* cache, Line* l)
+{
+    const Geometry* geometry = &cache->geometry;
+    uint64_t block = l->address >> geometry->offsetBits;
+    uint64_t tag = block >> geometry->indexBits;
+
+    // Probe Each Way's Set, Noting the Empty or Oldest Slot as the Fill Should the Block Miss
+    int hit = -1, fill = -1;
+    unsigned int hitIndex = 0, fillIndex = 0;
+    uint64_t oldest = 0;
+    unsigned int way;
+    for(way = 0; way < geometry->associativity; way++)
+    {
+        unsigned int index = hashedIndex(geometry, block, way);
+        uint64_t stamp = 0;
+        if(testWay(&cache->valid[(size_t)index * cache->maskWords], way))
+        {
+            if(loadTag(cache, cache->tags, (size_t)index * geometry->associativity + way) == tag)
+            {
+                hit = way;
+                hitIndex = index;
+                break;
+            }
+            stamp = ((uint64_t*)&cache->state[(size_t)index * cache->stateBytes])[way];
+        }
+        if(fill < 0 || stamp < oldest)
+        {
+            fill = way;
+            fillIndex = index;
+            oldest = stamp;
+        }
+    }
+
+    if(hit > -1)
+        cache->hits += 1;
+    else
+        cache->misses += 1;
+    if(cache->classifier)
+        classifyAccess(cache, l, hashedIndex(geometry, block, 0), hit > -1);
+
+    if(l->operation != 'R' && l->operation != 'W')
+        return;
+    char write = (l->operation == 'W');
+
+    if(hit < 0 && write && !cache->policy->writeAllocate)
+    {
+        // Non-Allocating Write Miss, Write Straight to Memory
+        referenceMemory(cache, l->address, 1);
+        return;
+    }
+    if(hit < 0)
+    {
+        // Read Miss or Allocating Write Miss, Fetch the Block (From the Victim Cache or Memory) Over the Oldest Candidate
+        if(!cache->victims || !probeVictims(cache->victims, block))
+        {
+            referenceMemory(cache, block << geometry->offsetBits, 0);
+            cache->fetches += 1;
+        }
+        if(testWay(&cache->valid[(size_t)fillIndex * cache->maskWords], fill))
+            retireBlock(cache, fillIndex, fill);
+        storeTag(cache, cache->tags, (size_t)fillIndex * geometry->associativity + fill, tag);
+        setWay(&cache->valid[(size_t)fillIndex * cache->maskWords], fill);
+        hit = fill;
+        hitIndex = fillIndex;
+    }
+
+    ((uint64_t*)&cache->state[(size_t)hitIndex * cache->stateBytes])[hit] = ++cache->clock;
+    if(write)
+    {
+        if(cache->policy->writeBack)
+            setWay(&cache->dirty[(size_t)hitIndex * cache->maskWords], hit);
+        else
+            referenceMemory(cache, l->address, 1);
+    }
+}
+
+/**
+ * @brief Simulate caching a single line. Inlined into cacheLine and every specialized kernel, where the offset bits
+ *        and associativity are constants and indexing is modulo, so the address split is fixed shifts and the way
+ *        loops unroll.
+ * @param Cache* cache Cache to simulate.
+ * @param Line* l Line to cache.
+ * @param unsigned int offsetBits The cache's offset bits.
+ * @param unsigned int associativity The cache's associativity.
+ * @param char indexing The cache's index function.
+ * @return void
+ */
+static inline __attribute__((always_inline)) void accessCache(Cache* cache, Line* l, unsigned int offsetBits, unsigned int associativity, char indexing)
+{
+    // Close the Interval Once it Holds Its Length in References
+    if(cache->intervals)
+    {
+        if(cache->cacheReferences - cache->intervals->references >= cache->intervals->length)
+            closeInterval(cache);
+        touchIntervalBlock(cache->intervals, l->address >> offsetBits);
+    }
+    cache->cacheReferences += 1;
+
+    // Another Read or Write to the Block the Last Reference Left Resident is Certain to Hit
+    if((l->address >> offsetBits) == cache->lastBlock && (l->operation == 'R' || l->operation == 'W'))
+    {
+        cache->hits += 1;
+        cache->replacement->touch(&cache->state[(size_t)cache->lastIndex * cache->stateBytes], associativity, cache->lastWay);
+        if(l->operation == 'W')
+        {
+            if(cache->policy->writeBack)
+                setWay(&cache->dirty[(size_t)cache->lastIndex * cache->maskWords], cache->lastWay);
+            else
+                referenceMemory(cache, l->address, 1);
+        }
+        return;
+    }
+    if(indexing == 's')
+    {
+        skewedAccess(cache, l);
+        return;
+    }
+
+    // Break the Address Down Once
+    unsigned int index;
+    uint64_t tag;
+    if(indexing)
+    {
+        index = getIndexBits(&cache->geometry, l->address);
+        tag = getTagBits(&cache->geometry, l->address);
+    }
+    else
+    {
+        index = (l->address >> offsetBits) & ((1u << cache->geometry.indexBits) - 1);
+        tag = l->address >> (offsetBits + cache->geometry.indexBits);
+    }
+    uint64_t* dirty = &cache->dirty[(size_t)index * cache->maskWords];
+    unsigned char* state = &cache->state[(size_t)index * cache->stateBytes];
+
+    // Check for Existing Identical Tag to Update
+    int hit = findWayIn(cache, index, tag, associativity);
+    if(hit > -1)
+        cache->hits += 1;
+    else
+        cache->misses += 1;
+    if(cache->classifier)
+        classifyAccess(cache, l, index, hit > -1);
+
+    // ---------- Process ----------
+    if(l->operation != 'R' && l->operation != 'W')
+        return;
+    char write = (l->operation == 'W');
+
+    int resident = hit;
+    if(hit > -1)
+    {
+        // Read or Write Hit
+        cache->replacement->touch(state, associativity, hit);
+        if(write)
+        {
+            if(cache->policy->writeBack)
+                setWay(dirty, hit);
+            else
+                referenceMemory(cache, l->address, 1);
+        }
+    }
+    else if(!write || cache->policy->writeAllocate)
+    {
+        // Read Miss or Allocating Write Miss, Fetch the Block (From the Victim Cache or Memory) Into an Empty Block or by Replacement
+        if(!cache->victims || !probeVictims(cache->victims, l->address >> offsetBits))
+        {
+            referenceMemory(cache, (l->address >> offsetBits) << offsetBits, 0);
+            cache->fetches += 1;
+        }
+
+        int fill = findFreeWayIn(cache, index, associativity);
+        if(fill > -1)
+        {
+            storeTag(cache, cache->tags, (size_t)index * associativity + fill, tag);
+            setWay(&cache->valid[(size_t)index * cache->maskWords], fill);
+            cache->replacement->fill(state, associativity, fill);
+        }
+        else
+        {
+            fill = replaceBlock(cache, index, tag);
+        }
+        resident = fill;
+
+        if(write)
+        {
+            if(cache->policy->writeBack)
+                setWay(dirty, fill);
+            else
+                referenceMemory(cache, l->address, 1);
+        }
+    }
+    else
+    {
+        // Non-Allocating Write Miss, Write Straight to Memory
+        referenceMemory(cache, l->address, 1);
+    }
+
+    // Prefetches Can Evict the Block and the Shadow Must See Every Reference, so Neither Takes the Fast Path
+    if(cache->prefetcher)
+        trainPrefetcher(cache, l->address, index, tag, hit);
+    if(resident > -1 && !cache->prefetcher && !cache->classifier)
+    {
+        cache->lastBlock = l->address >> offsetBits;
+        cache->lastIndex = index;
+        cache->lastWay = resident;
+    }
+    else
+    {
+        cache->lastBlock = NO_ADDRESS;
+    }
+}
+
+void cacheLine(Cache* cache, Line* l)
+{
+    accessCache(cache, l, cache->geometry.offsetBits, cache->geometry.associativity, cache->geometry.indexing);
+}
+
+/**
+ * @brief Generic kernel, simulating a batch line by line for any geometry.
+ * @param Cache* cache Cache to simulate.
+ * @param Line* lines Lines to cache, in order.
+ * @param unsigned int count Number of lines.
+ * @return void
+ */
+static void genericKernel(Cache* cache, Line* lines, unsigned int count)
+{
+    unsigned int i;
+    for(i = 0; i < count; i++)
+    {
+        cacheLine(cache, &lines[i]);
+    }
+}
+
+// Kernels Specialized per Block Size and Associativity, the Constants Folded Into accessCache
+#define DEFINE_KERNEL(BLOCK, OFFSET, WAYS)                                          \
+    static void kernel##BLOCK##x##WAYS(Cache* cache, Line* lines, unsigned int count) \
+    {                                                                               \
+        unsigned int i;                                                             \
+        for(i = 0; i < count; i++)                                                  \
+            accessCache(cache, &lines[i], OFFSET, WAYS, 0);                         \
+    }
+#define DEFINE_KERNELS(BLOCK, OFFSET) \
+    DEFINE_KERNEL(BLOCK, OFFSET, 1)   \
+    DEFINE_KERNEL(BLOCK, OFFSET, 2)   \
+    DEFINE_KERNEL(BLOCK, OFFSET, 4)   \
+    DEFINE_KERNEL(BLOCK, OFFSET, 8)   \
+    DEFINE_KERNEL(BLOCK, OFFSET, 16)
+DEFINE_KERNELS(32, 5)
+DEFINE_KERNELS(64, 6)
+DEFINE_KERNELS(128, 7)
+
+static const SimulationKernel KERNELS[KERNEL_BLOCK_SIZES][KERNEL_ASSOCIATIVITIES] = {
+    {kernel32x1, kernel32x2, kernel32x4, kernel32x8, kernel32x16},
+    {kernel64x1, kernel64x2, kernel64x4, kernel64x8, kernel64x16},
+    {kernel128x1, kernel128x2, kernel128x4, kernel128x8, kernel128x16}
+};
+
+SimulationKernel selectKernel(const Geometry* geometry)
+{
+    // Block Sizes 32 to 128 and Associativities 1 to 16, Powers of Two Only, Indexed by Plain Modulo
+    unsigned int associativity = geometry->associativity;
+    if(geometry->indexing || geometry->blockSize < 32 || geometry->blockSize > 128 || associativity > 16 || (associativity & (associativity - 1)))
+        return genericKernel;
+    return KERNELS[geometry->offsetBits - 5][__builtin_ctz(associativity)];
+}
+
+void cacheRun(Cache* cache, Line* lines, unsigned int length, unsigned int writes)
+{
+    // Reference by Reference Until the Block is Resident (or Throughout, When Intervals Must Count Each One or the
+    // DRAM Must See Each Written Through Word Arrive)
+    uint64_t block = lines[0].address >> cache->geometry.offsetBits;
+    unsigned int i = 0;
+    while(i < length && (cache->lastBlock != block || cache->intervals || cache->dram))
+    {
+        writes -= (lines[i].operation == 'W');
+        cacheLine(cache, &lines[i++]);
+    }
+    if(i == length)
+        return;
+
+    // Touching the Most Recent Way Again Leaves Every Replacement Policy's State as it Was, so One Touch Covers the Run
+    unsigned int rest = length - i;
+    cache->cacheReferences += rest;
+    cache->hits += rest;
+    cache->replacement->touch(&cache->state[(size_t)cache->lastIndex * cache->stateBytes], cache->geometry.associativity, cache->lastWay);
+    if(writes)
+    {
+        if(cache->policy->writeBack)
+            setWay(&cache->dirty[(size_t)cache->lastIndex * cache->maskWords], cache->lastWay);
+        else
+            cache->memrefs += writes;
+    }
+}
+
+void simulate(Cache* cache)
+{
+    cache->kernel(cache, LINE_LIST->lines, LINE_LIST->size);
+}
+
+/**
+ * @brief Run each cache over a whole batch of lines while the batch is hot, run by run when it is run-length encoded.
+ * @param Cache** caches Caches to simulate.
+ * @param int count Number of caches.
+ * @param Line* lines The batch's lines.
+ * @param unsigned int size Number of lines.
+ * @param const unsigned int* runs Length and write count of each run, NULL to run the lines one by one.
+ * @param unsigned int runCount Number of runs.
+ * @return void
+ */
+static void simulateBatch(Cache** caches, int count, Line* lines, unsigned int size, const unsigned int* runs, unsigned int runCount)
+{
+    int c;
+    for(c = 0; c < count; c++)
+    {
+        if(!runs)
+        {
+            caches[c]->kernel(caches[c], lines, size);
+            continue;
+        }
+        unsigned int i;
+        unsigned int r;
+        for(i = 0, r = 0; r < runCount; i += runs[r * 2], r++)
+        {
+            if(runs[r * 2] == 1)
+                cacheLine(caches[c], &lines[i]);
+            else
+                cacheRun(caches[c], &lines[i], runs[r * 2], runs[r * 2 + 1]);
+        }
+    }
+}
+
+void simulateStream(TraceReader* reader, Cache** caches, int count)
+{
+    Line lines[TRACE_BATCH_SIZE];
+    unsigned int size;
+    while((size = readTraceBatch(reader, lines, TRACE_BATCH_SIZE)) > 0)
+        simulateBatch(caches, count, lines, size, NULL, 0);
+}
+
+/**
+ * @brief Pipeline reader thread, decodes batches into free slots until the trace is exhausted.
+ * @param void* arg The pipeline.
+ * @return void* NULL
+ */
+static void* pipelineReader(void* arg)
+{
+    LinePipeline* pipeline = (LinePipeline*)arg;
+    unsigned long tail = 0;
+    unsigned int size;
+    do
+    {
+        // Wait While Every Slot Holds an Unconsumed Batch
+        while(tail - atomic_load_explicit(&pipeline->head, memory_order_acquire) == PIPELINE_SLOTS)
+            sched_yield();
+        unsigned int slot = tail % PIPELINE_SLOTS;
+        Line* lines = &pipeline->batches[(size_t)slot * TRACE_BATCH_SIZE];
+        size = readTraceBatch(pipeline->reader, lines, TRACE_BATCH_SIZE);
+        pipeline->sizes[slot] = size;
+        if(pipeline->runs)
+        {
+            // Run Length Encode Consecutive Reads and Writes to One Block, Anything Else Runs Alone
+            unsigned int* runs = &pipeline->runs[(size_t)slot * TRACE_BATCH_SIZE * 2];
+            unsigned int count = 0;
+            unsigned int i = 0;
+            while(i < size)
+            {
+                unsigned int start = i;
+                unsigned int writes = (lines[i].operation == 'W');
+                uint64_t block = lines[i].address >> pipeline->runShift;
+                if(lines[i++].operation == 'R' || writes)
+                {
+                    while(i < size && (lines[i].address >> pipeline->runShift) == block &&
+                          (lines[i].operation == 'R' || lines[i].operation == 'W'))
+                        writes += (lines[i++].operation == 'W');
+                }
+                runs[count * 2] = i - start;
+                runs[count * 2 + 1] = writes;
+                count++;
+            }
+            pipeline->runCounts[slot] = count;
+        }
+        atomic_store_explicit(&pipeline->tail, ++tail, memory_order_release);
+    } while(size > 0);
+    return NULL;
+}
+
+void simulatePipelined(TraceReader* reader, Cache** caches, int count, char collapse)
+{
+    LinePipeline pipeline;
+    pipeline.reader = reader;
+    pipeline.batches = (Line*)malloc(sizeof(Line) * PIPELINE_SLOTS * TRACE_BATCH_SIZE);
+    pipeline.runs = collapse ? (unsigned int*)malloc(sizeof(unsigned int) * PIPELINE_SLOTS * TRACE_BATCH_SIZE * 2) : NULL;
+    pipeline.runShift = caches[0]->geometry.offsetBits;
+    atomic_init(&pipeline.head, 0);
+    atomic_init(&pipeline.tail, 0);
+    pthread_create(&pipeline.thread, NULL, pipelineReader, &pipeline);
+
+    unsigned long head = 0;
+    while(1)
+    {
+        // The Release Store of the Tail Publishes the Batch and its Size
+        while(atomic_load_explicit(&pipeline.tail, memory_order_acquire) == head)
+            sched_yield();
+        unsigned int slot = head % PIPELINE_SLOTS;
+        unsigned int size = pipeline.sizes[slot];
+        if(size == 0)
+            break;
+
+        if(pipeline.runs)
+            simulateBatch(caches, count, &pipeline.batches[(size_t)slot * TRACE_BATCH_SIZE], size,
+                          &pipeline.runs[(size_t)slot * TRACE_BATCH_SIZE * 2], pipeline.runCounts[slot]);
+        else
+            simulateBatch(caches, count, &pipeline.batches[(size_t)slot * TRACE_BATCH_SIZE], size, NULL, 0);
+
+        // Hand the Slot Back to the Reader Once Every Cache Has Run its Batch
+        atomic_store_explicit(&pipeline.head, ++head, memory_order_release);
+    }
+
+    pthread_join(pipeline.thread, NULL);
+    free(pipeline.batches);
+    free(pipeline.runs);
+}
+
+/**
+ * @brief Worker thread, simulates its shard's buffer every round until the pool shuts down.
+ * @param void* arg The worker's shard.
+ * @return void* NULL
+ */
+static void* shardWorker(void* arg)
+{
+    Shard* shard = (Shard*)arg;
+    ShardPool* pool = shard->pool;
+    unsigned long round;
+    for(round = 0; ; round++)
+    {
+        pthread_barrier_wait(&pool->barrier);
+        int buffer = round & 1;
+        if(pool->last[buffer])
+            return NULL;
+
+        if(pool->coherent)
+        {
+            unsigned int i;
+            for(i = 0; i < shard->sizes[buffer]; i++)
+            {
+                systemAccess(shard->system, &shard->lines[buffer][i]);
+            }
+            continue;
+        }
+
+        int c;
+        for(c = 0; c < pool->policies; c++)
+            shard->views[c].kernel(&shard->views[c], shard->lines[buffer], shard->sizes[buffer]);
+    }
+}
+
+/**
+ * @brief Read the next chunk of the trace and partition it into each shard's buffer.
+ * @param TraceReader* reader Reader to parse from.
+ * @param ShardPool* pool Pool to partition into.
+ * @param int buffer Buffer to fill.
+ * @return unsigned int Number of lines read.
+ */
+static unsigned int fillShards(TraceReader* reader, ShardPool* pool, int buffer)
+{
+    unsigned int s;
+    for(s = 0; s < pool->count; s++)
+        pool->shards[s].sizes[buffer] = 0;
+
+    Line lines[TRACE_BATCH_SIZE];
+    unsigned int total = 0;
+    unsigned int size;
+    while(total < SHARD_CHUNK_SIZE && (size = readTraceBatch(reader, lines, TRACE_BATCH_SIZE)) > 0)
+    {
+        unsigned int i;
+        for(i = 0; i < size; i++)
+        {
+            // Contiguous Set Ranges per Shard
+            const Geometry* geometry = pool->geometry;
+            Shard* shard = &pool->shards[(unsigned long)getIndexBits(geometry, lines[i].address) * pool->count / geometry->numSets];
+            shard->lines[buffer][shard->sizes[buffer]++] = lines[i];
+        }
+        total += size;
+    }
+    pool->last[buffer] = (total == 0);
+    return total;
+}
+
+/**
+ * @brief Start a pool of shards, with views already set up, and run it over the rest of the trace.
+ * @param TraceReader* reader Reader positioned after the trace header.
+ * @param ShardPool* pool Pool to run, joined once the trace is exhausted.
+ * @return void
+ */
+static void runShards(TraceReader* reader, ShardPool* pool)
+{
+    pthread_barrier_init(&pool->barrier, NULL, pool->count + 1);
+    unsigned int s;
+    for(s = 0; s < pool->count; s++)
+    {
+        // A Whole Chunk (Plus the Batch That Crosses the Limit) May Fall Within One Shard
+        pool->shards[s].pool = pool;
+        pool->shards[s].lines[0] = (Line*)malloc(sizeof(Line) * (SHARD_CHUNK_SIZE + TRACE_BATCH_SIZE));
+        pool->shards[s].lines[1] = (Line*)malloc(sizeof(Line) * (SHARD_CHUNK_SIZE + TRACE_BATCH_SIZE));
+    }
+
+    fillShards(reader, pool, 0);
+    for(s = 0; s < pool->count; s++)
+        pthread_create(&pool->shards[s].thread, NULL, shardWorker, &pool->shards[s]);
+
+    // Each Barrier Starts a Round, the Main Thread Fills One Buffer While the Workers Consume the Other
+    unsigned long round;
+    for(round = 0; ; round++)
+    {
+        pthread_barrier_wait(&pool->barrier);
+        if(pool->last[round & 1])
+            break;
+        fillShards(reader, pool, (round + 1) & 1);
+    }
+
+    for(s = 0; s < pool->count; s++)
+    {
+        pthread_join(pool->shards[s].thread, NULL);
+        free(pool->shards[s].lines[0]);
+        free(pool->shards[s].lines[1]);
+    }
+    pthread_barrier_destroy(&pool->barrier);
+}
+
+void simulateSharded(TraceReader* reader, Cache** caches, int count, unsigned int threads)
+{
+    if(threads > caches[0]->geometry.numSets)
+        threads = caches[0]->geometry.numSets;
+
+    ShardPool pool;
+    pool.shards = (Shard*)calloc(threads, sizeof(Shard));
+    pool.count = threads;
+    pool.policies = count;
+    pool.geometry = &caches[0]->geometry;
+    pool.coherent = 0;
+
+    // Shards View the Shared Sets, but Count Into Private Counters
+    unsigned int s;
+    for(s = 0; s < threads; s++)
+    {
+        Shard* shard = &pool.shards[s];
+        int c;
+        for(c = 0; c < count; c++)
+        {
+            shard->views[c] = *caches[c];
+            shard->views[c].hits = 0;
+            shard->views[c].misses = 0;
+            shard->views[c].memrefs = 0;
+            shard->views[c].writebacks = 0;
+            shard->views[c].fetches = 0;
+            shard->views[c].cacheReferences = 0;
+        }
+    }
+
+    runShards(reader, &pool);
+
+    // Merge Thread Local Counters
+    for(s = 0; s < threads; s++)
+    {
+        Shard* shard = &pool.shards[s];
+        int c;
+        for(c = 0; c < count; c++)
+        {
+            caches[c]->hits += shard->views[c].hits;
+            caches[c]->misses += shard->views[c].misses;
+            caches[c]->memrefs += shard->views[c].memrefs;
+            caches[c]->writebacks += shard->views[c].writebacks;
+            caches[c]->fetches += shard->views[c].fetches;
+            caches[c]->cacheReferences += shard->views[c].cacheReferences;
+        }
+    }
+    free(pool.shards);
+}
+
+/**
+ * @brief Write an array to a checkpoint.
+ * @param FILE* file Checkpoint being written.
+ * @param const void* data Array to write.
+ * @param size_t bytes Size of the array.
+ * @return int 1 on success, 0 on failure.
+ */
+static int writeCheckpointBytes(FILE* file, const void* data, size_t bytes)
+{
+    return bytes == 0 || fwrite(data, 1, bytes, file) == bytes;
+}
+
+/**
+ * @brief Copy an array out of a mapped checkpoint, advancing the cursor.
+ * @param const unsigned char** cursor Position in the mapping.
+ * @param const unsigned char* end End of the mapping.
+ * @param void* data Destination of the array.
+ * @param size_t bytes Size of the array.
+ * @return int 1 on success, 0 if the checkpoint ends early.
+ */
+static int readCheckpointBytes(const unsigned char** cursor, const unsigned char* end, void* data, size_t bytes)
+{
+    if((size_t)(end - *cursor) < bytes)
+        return 0;
+    memcpy(data, *cursor, bytes);
+    *cursor += bytes;
+    return 1;
+}
+
+/**
+ * @brief List a cache's counters in checkpoint order.
+ * @param Cache* cache Cache to list the counters of.
+ * @param unsigned long** counters Destination, CHECKPOINT_COUNTERS pointers.
+ * @return void
+ */
+static void listCheckpointCounters(Cache* cache, unsigned long** counters)
+{
+    counters[0] = &cache->cacheReferences;
+    counters[1] = &cache->hits;
+    counters[2] = &cache->misses;
+    counters[3] = &cache->memrefs;
+    counters[4] = &cache->writebacks;
+    counters[5] = &cache->fetches;
+    counters[6] = &cache->prefetches;
+    counters[7] = &cache->usefulPrefetches;
+    counters[8] = &cache->pollution;
+}
+
+/**
+ * @brief Encode a cache's configuration, the size of its classifier's set, and its counters as a checkpoint cache record.
+ * @param Cache* cache Cache to describe.
+ * @param unsigned char* record Destination, CHECKPOINT_CACHE_SIZE bytes.
+ * @return void
+ */
+static void encodeCheckpointCache(Cache* cache, unsigned char* record)
+{
+    // Configuration, Which a Restore Must Match Byte for Byte
+    unsigned char* cursor = record;
+    cursor = putLittleEndian(cursor, cache->geometry.blockSize, 4);
+    cursor = putLittleEndian(cursor, cache->geometry.numSets, 4);
+    cursor = putLittleEndian(cursor, cache->geometry.associativity, 4);
+    cursor = putLittleEndian(cursor, cache->victims ? cache->victims->entries : 0, 4);
+    cursor = putLittleEndian(cursor, cache->policy->id, 1);
+    cursor = putLittleEndian(cursor, cache->replacement - REPLACEMENT_POLICIES, 1);
+    cursor = putLittleEndian(cursor, cache->prefetcher ? cache->prefetcher - PREFETCHERS + 1 : 0, 1);
+    cursor = putLittleEndian(cursor, cache->victims ? cache->victims->kind : 0, 1);
+    cursor = putLittleEndian(cursor, cache->classifier != NULL, 1);
+    cursor = putLittleEndian(cursor, cache->geometry.addressBits, 1);
+    cursor = putLittleEndian(cursor, cache->geometry.indexing, 1);
+    cursor = putLittleEndian(cursor, 0, 1);
+
+    cursor = putLittleEndian(cursor, cache->classifier ? cache->classifier->seenMask : 0, 4);
+    unsigned long* counters[CHECKPOINT_COUNTERS];
+    listCheckpointCounters(cache, counters);
+    int i;
+    for(i = 0; i < CHECKPOINT_COUNTERS; i++)
+        cursor = putLittleEndian(cursor, *counters[i], 8);
+}
+
+int saveCheckpoint(Cache** caches, int count, const char* path)
+{
+    FILE* file = fopen(path, "wb");
+    if(!file)
+    {
+        fprintf(stderr, "Unable to open checkpoint %s\n", path);
+        return 0;
+    }
+
+    // The Byte Order Marker is Native, so Restores Can Reject Checkpoints Whose Arrays Would Read Backwards
+    unsigned char header[CHECKPOINT_HEADER_SIZE];
+    uint32_t order = CHECKPOINT_BYTE_ORDER;
+    memcpy(header, CHECKPOINT_MAGIC, 4);
+    putLittleEndian(header + 4, CHECKPOINT_VERSION, 4);
+    memcpy(header + 8, &order, 4);
+    putLittleEndian(header + 12, count, 4);
+    int ok = writeCheckpointBytes(file, header, CHECKPOINT_HEADER_SIZE);
+
+    int c;
+    for(c = 0; c < count && ok; c++)
+    {
+        Cache* cache = caches[c];
+        size_t ways = (size_t)cache->geometry.numSets * cache->geometry.associativity;
+        size_t words = (size_t)cache->geometry.numSets * cache->maskWords;
+        unsigned char record[CHECKPOINT_CACHE_SIZE];
+        encodeCheckpointCache(cache, record);
+        ok = writeCheckpointBytes(file, record, CHECKPOINT_CACHE_SIZE) &&
+             writeCheckpointBytes(file, cache->tags, (size_t)cache->tagBytes * ways) &&
+             writeCheckpointBytes(file, cache->valid, sizeof(uint64_t) * words) &&
+             writeCheckpointBytes(file, cache->dirty, sizeof(uint64_t) * words) &&
+             writeCheckpointBytes(file, cache->state, (size_t)cache->stateBytes * cache->geometry.numSets);
+        if(ok && cache->prefetcher)
+        {
+            ok = writeCheckpointBytes(file, cache->prefetchState, cache->prefetcher->stateBytes) &&
+                 writeCheckpointBytes(file, cache->prefetched, sizeof(uint64_t) * words) &&
+                 writeCheckpointBytes(file, cache->pollutedTags, (size_t)cache->tagBytes * ways) &&
+                 writeCheckpointBytes(file, cache->polluted, sizeof(uint64_t) * words);
+        }
+        if(ok && cache->victims)
+        {
+            const VictimCache* victims = cache->victims;
+            ok = writeCheckpointBytes(file, victims->blocks, sizeof(uint64_t) * victims->entries) &&
+                 writeCheckpointBytes(file, victims->used, sizeof(unsigned long) * victims->entries) &&
+                 writeCheckpointBytes(file, &victims->clock, sizeof(unsigned long)) &&
+                 writeCheckpointBytes(file, &victims->hits, sizeof(unsigned long));
+        }
+        if(ok && cache->classifier)
+        {
+            const Classifier* classifier = cache->classifier;
+            ok = writeCheckpointBytes(file, &classifier->size, sizeof(unsigned int)) &&
+                 writeCheckpointBytes(file, &classifier->head, sizeof(unsigned int)) &&
+                 writeCheckpointBytes(file, &classifier->tail, sizeof(unsigned int)) &&
+                 writeCheckpointBytes(file, &classifier->seenCount, sizeof(unsigned int)) &&
+                 writeCheckpointBytes(file, classifier->blocks, sizeof(uint64_t) * classifier->capacity) &&
+                 writeCheckpointBytes(file, classifier->prev, sizeof(unsigned int) * classifier->capacity) &&
+                 writeCheckpointBytes(file, classifier->next, sizeof(unsigned int) * classifier->capacity) &&
+                 writeCheckpointBytes(file, classifier->nodes, sizeof(unsigned int) * (classifier->nodeMask + 1)) &&
+                 writeCheckpointBytes(file, classifier->seen, sizeof(uint64_t) * ((size_t)classifier->seenMask + 1)) &&
+                 writeCheckpointBytes(file, classifier->counts, sizeof(unsigned long) * cache->geometry.numSets * 3);
+        }
+    }
+
+    if(fclose(file) != 0)
+        ok = 0;
+    if(!ok)
+        fprintf(stderr, "Unable to write checkpoint %s\n", path);
+    return ok;
+}
+
+int restoreCheckpoint(Cache** caches, int count, const char* path)
+{
+    int fd = open(path, O_RDONLY);
+    struct stat info;
+    if(fd < 0 || fstat(fd, &info) != 0 || info.st_size < CHECKPOINT_HEADER_SIZE)
+    {
+        fprintf(stderr, "Unable to open checkpoint %s\n", path);
+        if(fd >= 0)
+            close(fd);
+        return 0;
+    }
+    void* mapping = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(mapping == MAP_FAILED)
+    {
+        fprintf(stderr, "Unable to map checkpoint %s\n", path);
+        return 0;
+    }
+    madvise(mapping, info.st_size, MADV_SEQUENTIAL);
+
+    const unsigned char* cursor = (const unsigned char*)mapping;
+    const unsigned char* end = cursor + info.st_size;
+    uint32_t order;
+    memcpy(&order, cursor + 8, 4);
+    int ok = memcmp(cursor, CHECKPOINT_MAGIC, 4) == 0 && getLittleEndian(cursor + 4, 4) == CHECKPOINT_VERSION &&
+             order == CHECKPOINT_BYTE_ORDER && getLittleEndian(cursor + 12, 4) == (uint64_t)count;
+    cursor += CHECKPOINT_HEADER_SIZE;
+
+    int c;
+    for(c = 0; c < count && ok; c++)
+    {
+        Cache* cache = caches[c];
+        size_t ways = (size_t)cache->geometry.numSets * cache->geometry.associativity;
+        size_t words = (size_t)cache->geometry.numSets * cache->maskWords;
+
+        unsigned char expected[CHECKPOINT_CACHE_SIZE];
+        encodeCheckpointCache(cache, expected);
+        if((size_t)(end - cursor) < CHECKPOINT_CACHE_SIZE || memcmp(cursor, expected, CHECKPOINT_CONFIG_SIZE) != 0)
+        {
+            ok = 0;
+            break;
+        }
+        unsigned int seenMask = getLittleEndian(cursor + CHECKPOINT_CONFIG_SIZE, 4);
+        unsigned long* counters[CHECKPOINT_COUNTERS];
+        listCheckpointCounters(cache, counters);
+        int i;
+        for(i = 0; i < CHECKPOINT_COUNTERS; i++)
+            *counters[i] = getLittleEndian(cursor + CHECKPOINT_CONFIG_SIZE + 4 + i * 8, 8);
+        cursor += CHECKPOINT_CACHE_SIZE;
+
+        ok = readCheckpointBytes(&cursor, end, cache->tags, (size_t)cache->tagBytes * ways) &&
+             readCheckpointBytes(&cursor, end, cache->valid, sizeof(uint64_t) * words) &&
+             readCheckpointBytes(&cursor, end, cache->dirty, sizeof(uint64_t) * words) &&
+             readCheckpointBytes(&cursor, end, cache->state, (size_t)cache->stateBytes * cache->geometry.numSets);
+        if(ok && cache->prefetcher)
+        {
+            ok = readCheckpointBytes(&cursor, end, cache->prefetchState, cache->prefetcher->stateBytes) &&
+                 readCheckpointBytes(&cursor, end, cache->prefetched, sizeof(uint64_t) * words) &&
+                 readCheckpointBytes(&cursor, end, cache->pollutedTags, (size_t)cache->tagBytes * ways) &&
+                 readCheckpointBytes(&cursor, end, cache->polluted, sizeof(uint64_t) * words);
+        }
+        if(ok && cache->victims)
+        {
+            VictimCache* victims = cache->victims;
+            ok = readCheckpointBytes(&cursor, end, victims->blocks, sizeof(uint64_t) * victims->entries) &&
+                 readCheckpointBytes(&cursor, end, victims->used, sizeof(unsigned long) * victims->entries) &&
+                 readCheckpointBytes(&cursor, end, &victims->clock, sizeof(unsigned long)) &&
+                 readCheckpointBytes(&cursor, end, &victims->hits, sizeof(unsigned long));
+        }
+        if(ok && cache->classifier)
+        {
+            Classifier* classifier = cache->classifier;
+            if(seenMask < 1023 || (seenMask & (seenMask + 1)))
+            {
+                ok = 0;
+                break;
+            }
+            free(classifier->seen);
+            classifier->seenMask = seenMask;
+            classifier->seen = (uint64_t*)malloc(sizeof(uint64_t) * ((size_t)seenMask + 1));
+            ok = readCheckpointBytes(&cursor, end, &classifier->size, sizeof(unsigned int)) &&
+                 readCheckpointBytes(&cursor, end, &classifier->head, sizeof(unsigned int)) &&
+                 readCheckpointBytes(&cursor, end, &classifier->tail, sizeof(unsigned int)) &&
+                 readCheckpointBytes(&cursor, end, &classifier->seenCount, sizeof(unsigned int)) &&
+                 readCheckpointBytes(&cursor, end, classifier->blocks, sizeof(uint64_t) * classifier->capacity) &&
+                 readCheckpointBytes(&cursor, end, classifier->prev, sizeof(unsigned int) * classifier->capacity) &&
+                 readCheckpointBytes(&cursor, end, classifier->next, sizeof(unsigned int) * classifier->capacity) &&
+                 readCheckpointBytes(&cursor, end, classifier->nodes, sizeof(unsigned int) * (classifier->nodeMask + 1)) &&
+                 readCheckpointBytes(&cursor, end, classifier->seen, sizeof(uint64_t) * ((size_t)seenMask + 1)) &&
+                 readCheckpointBytes(&cursor, end, classifier->counts, sizeof(unsigned long) * cache->geometry.numSets * 3);
+        }
+    }
+
+    munmap(mapping, info.st_size);
+    if(!ok || cursor != end)
+    {
+        // Leave No Half Restored Cache Behind
+        for(c = 0; c < count; c++)
+            resetCache(caches[c]);
+        fprintf(stderr, "Checkpoint %s is malformed or does not match the configured caches\n", path);
+        return 0;
+    }
+
+    // The Restored Contents Replace Whatever the Last Reference Left Resident, Intervals Start From the Restored
+    // Counters, and Skewed Caches Stamp On From the Newest
+    for(c = 0; c < count; c++)
+    {
+        Cache* cache = caches[c];
+        cache->lastBlock = NO_ADDRESS;
+        if(cache->intervals)
+            resetIntervalLog(cache);
+        if(cache->geometry.indexing == 's')
+        {
+            const uint64_t* stamps = (const uint64_t*)cache->state;
+            size_t i;
+            for(i = 0; i < (size_t)cache->geometry.numSets * cache->geometry.associativity; i++)
+            {
+                if(stamps[i] > cache->clock)
+                    cache->clock = stamps[i];
+            }
+        }
+    }
+    return 1;
+}
+
+System* initSystem(const Geometry* geometry, unsigned int count, char protocol)
+{
+    System* system = (System*)calloc(1, sizeof(System));
+    system->count = count;
+    system->protocol = protocol;
+    system->cores = (Cache**)malloc(sizeof(Cache*) * count);
+    system->coherenceMisses = (unsigned long*)calloc(count, sizeof(unsigned long));
+
+    unsigned int c;
+    for(c = 0; c < count; c++)
+        system->cores[c] = initCache(geometry, findWritePolicy('B'), OPTIONS.replacement);
+    size_t words = (size_t)count * geometry->numSets * system->cores[0]->maskWords;
+    system->shared = (uint64_t*)calloc(words, sizeof(uint64_t));
+    system->stale = (uint64_t*)calloc(words, sizeof(uint64_t));
+    return system;
+}
+
+void deinitSystem(System* system)
+{
+    unsigned int c;
+    for(c = 0; c < system->count; c++)
+        deinitCache(system->cores[c]);
+    free(system->cores);
+    free(system->coherenceMisses);
+    free(system->shared);
+    free(system->stale);
+    free(system);
+}
+
+/**
+ * @brief Find a way of a core's set that was invalidated by another core while holding a tag.
+ * @param const Cache* cache The core's cache.
+ * @param const uint64_t* stale The set's invalidated ways.
+ * @param unsigned int index Set to search.
+ * @param uint64_t tag Tag to find.
+ * @return int Way that held the tag, -1 if the tag was not invalidated.
+ */
+static int findStaleWay(const Cache* cache, const uint64_t* stale, unsigned int index, uint64_t tag)
+{
+    size_t base = (size_t)index * cache->geometry.associativity;
+    unsigned int word;
+    for(word = 0; word < cache->maskWords; word++)
+    {
+        uint64_t ways = stale[word];
+        while(ways)
+        {
+            unsigned int way = word * 64 + __builtin_ctzll(ways);
+            if(loadTag(cache, cache->tags, base + way) == tag)
+                return way;
+            ways &= ways - 1;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Snoop every other core for a block missed by one core, downgrading or invalidating their copies.
+ * @param System* system System to snoop.
+ * @param unsigned int core Core that missed (or is upgrading).
+ * @param unsigned int index Set of the block.
+ * @param uint64_t tag Tag of the block.
+ * @param char write Indicates the core wants the only copy, so every other copy is invalidated.
+ * @param int* supplied Set when another core's cache supplies the block (from M, O or E).
+ * @return int 1 if another core still holds a copy, 0 otherwise.
+ */
+static int snoopCores(System* system, unsigned int core, unsigned int index, uint64_t tag, char write, int* supplied)
+{
+    int sharers = 0;
+    *supplied = 0;
+    unsigned int other;
+    for(other = 0; other < system->count; other++)
+    {
+        Cache* cache = system->cores[other];
+        int way = (other == core) ? -1 : findWay(cache, index, tag);
+        if(way < 0)
+            continue;
+
+        size_t mask = ((size_t)other * cache->geometry.numSets + index) * cache->maskWords;
+        uint64_t* dirty = &cache->dirty[(size_t)index * cache->maskWords];
+        uint64_t* shared = &system->shared[mask];
+        int modified = testWay(dirty, way);
+        int exclusive = !testWay(shared, way);
+        if(modified || exclusive)
+            *supplied = 1;
+
+        if(write)
+        {
+            // Invalidate, Keeping the Tag to Recognize the Coherence Miss (Modified Data Moves to the Writer)
+            clearWay(&cache->valid[(size_t)index * cache->maskWords], way);
+            clearWay(dirty, way);
+            clearWay(shared, way);
+            setWay(&system->stale[mask], way);
+            system->invalidations += 1;
+            continue;
+        }
+
+        sharers = 1;
+        if(modified && system->protocol == 'm')
+        {
+            // MESI: M Supplies the Block and Writes it Back, Becoming S
+            clearWay(dirty, way);
+            cache->memrefs += 1;
+            system->writebacks += 1;
+        }
+        // MOESI: M Becomes O and Keeps the Block Dirty, O Stays O, E Becomes S
+        setWay(shared, way);
+    }
+    return sharers;
+}
+
+void systemAccess(System* system, Line* l)
+{
+    if(l->core >= system->count)
+    {
+        system->ignored += 1;
+        return;
+    }
+
+    unsigned int core = l->core;
+    Cache* cache = system->cores[core];
+    const Geometry* geometry = &cache->geometry;
+    unsigned int index = getIndexBits(geometry, l->address);
+    uint64_t tag = getTagBits(geometry, l->address);
+    size_t mask = ((size_t)core * geometry->numSets + index) * cache->maskWords;
+    uint64_t* dirty = &cache->dirty[(size_t)index * cache->maskWords];
+    uint64_t* shared = &system->shared[mask];
+    unsigned char* state = &cache->state[(size_t)index * cache->stateBytes];
+    cache->cacheReferences += 1;
+
+    int way = findWay(cache, index, tag);
+    if(way > -1)
+        cache->hits += 1;
+    else
+        cache->misses += 1;
+
+    if(l->operation != 'R' && l->operation != 'W')
+        return;
+    char write = (l->operation == 'W');
+    int supplied;
+
+    if(way > -1)
+    {
+        cache->replacement->touch(state, geometry->associativity, way);
+        if(!write)
+            return;
+
+        // Write Hit, E Becomes M Silently, While S and O Invalidate the Other Copies First
+        if(testWay(shared, way))
+        {
+            snoopCores(system, core, index, tag, 1, &supplied);
+            clearWay(shared, way);
+            system->upgrades += 1;
+        }
+        setWay(dirty, way);
+        return;
+    }
+
+    // Miss, Which is a Coherence Miss if Another Core's Write Took the Block Away
+    int fill = findStaleWay(cache, &system->stale[mask], index, tag);
+    if(fill > -1)
+        system->coherenceMisses[core] += 1;
+
+    int sharers = snoopCores(system, core, index, tag, write, &supplied);
+    if(supplied)
+        system->interventions += 1;
+    else
+        cache->memrefs += 1;
+
+    // Fill an Invalidated or Empty Way, Otherwise Replace, Writing Back M and O Victims
+    if(fill < 0)
+        fill = findFreeWay(cache, index);
+    if(fill < 0)
+    {
+        fill = cache->replacement->victim(state, geometry->associativity);
+        if(testWay(dirty, fill))
+        {
+            cache->memrefs += 1;
+            system->writebacks += 1;
+        }
+    }
+
+    storeTag(cache, cache->tags, (size_t)index * geometry->associativity + fill, tag);
+    setWay(&cache->valid[(size_t)index * cache->maskWords], fill);
+    clearWay(&system->stale[mask], fill);
+    cache->replacement->fill(state, geometry->associativity, fill);
+
+    // Writers Hold M, Readers Hold S Alongside Other Copies and E Otherwise
+    if(write)
+        setWay(dirty, fill);
+    else
+        clearWay(dirty, fill);
+    if(!write && sharers)
+        setWay(shared, fill);
+    else
+        clearWay(shared, fill);
+}
+
+void simulateSystem(TraceReader* reader, System* system, unsigned int threads)
+{
+    const Geometry* geometry = &system->cores[0]->geometry;
+    if(threads > geometry->numSets)
+        threads = geometry->numSets;
+    if(threads <= 1)
+    {
+        Line lines[TRACE_BATCH_SIZE];
+        unsigned int size;
+        while((size = readTraceBatch(reader, lines, TRACE_BATCH_SIZE)) > 0)
+        {
+            unsigned int i;
+            for(i = 0; i < size; i++)
+            {
+                systemAccess(system, &lines[i]);
+            }
+        }
+        return;
+    }
+
+    ShardPool pool;
+    pool.shards = (Shard*)calloc(threads, sizeof(Shard));
+    pool.count = threads;
+    pool.policies = 0;
+    pool.geometry = geometry;
+    pool.coherent = 1;
+
+    // Shards View the Shared Cores, but Count Into Private Counters
+    unsigned int s, c;
+    for(s = 0; s < threads; s++)
+    {
+        System* view = (System*)malloc(sizeof(System));
+        *view = *system;
+        view->cores = (Cache**)malloc(sizeof(Cache*) * system->count);
+        view->coherenceMisses = (unsigned long*)calloc(system->count, sizeof(unsigned long));
+        view->invalidations = 0;
+        view->interventions = 0;
+        view->upgrades = 0;
+        view->writebacks = 0;
+        view->ignored = 0;
+        for(c = 0; c < system->count; c++)
+        {
+            view->cores[c] = (Cache*)malloc(sizeof(Cache));
+            *view->cores[c] = *system->cores[c];
+            view->cores[c]->hits = 0;
+            view->cores[c]->misses = 0;
+            view->cores[c]->memrefs = 0;
+            view->cores[c]->cacheReferences = 0;
+        }
+        pool.shards[s].system = view;
+    }
+
+    runShards(reader, &pool);
+
+    // Merge Thread Local Counters
+    for(s = 0; s < threads; s++)
+    {
+        System* view = pool.shards[s].system;
+        for(c = 0; c < system->count; c++)
+        {
+            system->cores[c]->hits += view->cores[c]->hits;
+            system->cores[c]->misses += view->cores[c]->misses;
+            system->cores[c]->memrefs += view->cores[c]->memrefs;
+            system->cores[c]->cacheReferences += view->cores[c]->cacheReferences;
+            system->coherenceMisses[c] += view->coherenceMisses[c];
+            free(view->cores[c]);
+        }
+        system->invalidations += view->invalidations;
+        system->interventions += view->interventions;
+        system->upgrades += view->upgrades;
+        system->writebacks += view->writebacks;
+        system->ignored += view->ignored;
+        free(view->cores);
+        free(view->coherenceMisses);
+        free(view);
+    }
+    free(pool.shards);
+}
+
+void printSystemReport(System* system)
+{
+    char* div = "****************************************\n";
+    printf("%s", div);
+    printf("%s Coherence, %u Cores\n", system->protocol == 'o' ? "MOESI" : "MESI", system->count);
+    printf("%s", div);
+
+    printf("Core,References,Hits,Misses,Coherence Misses,Memory References\n");
+    unsigned long references = 0, hits = 0, misses = 0, coherenceMisses = 0, memrefs = 0;
+    unsigned int c;
+    for(c = 0; c < system->count; c++)
+    {
+        Cache* cache = system->cores[c];
+        printf("%u,%lu,%lu,%lu,%lu,%lu\n", c, cache->cacheReferences, cache->hits, cache->misses,
+               system->coherenceMisses[c], cache->memrefs);
+        references += cache->cacheReferences;
+        hits += cache->hits;
+        misses += cache->misses;
+        coherenceMisses += system->coherenceMisses[c];
+        memrefs += cache->memrefs;
+    }
+
+    printf("Total number of references: %lu\n", references);
+    printf("Hits: %lu\n", hits);
+    printf("Misses: %lu\n", misses);
+    printf("Coherence misses: %lu\n", coherenceMisses);
+    printf("Invalidations: %lu\n", system->invalidations);
+    printf("Interventions: %lu\n", system->interventions);
+    printf("Upgrades: %lu\n", system->upgrades);
+    printf("Writebacks: %lu\n", system->writebacks);
+    printf("Memory References: %lu\n", memrefs);
+    if(system->ignored)
+        printf("Ignored references from cores beyond %u: %lu\n", system->count, system->ignored);
+}
+
+/**
+ * @brief Parse one field of a sweep specification.
+ * @param const char* field Comma separated values and power of two ranges, up to the next ':' or the end.
+ * @param unsigned int* values Destination of the values.
+ * @return int Number of values, 0 if the field is malformed.
+ */
+static int parseSweepField(const char* field, unsigned int* values)
+{
+    int count = 0;
+    while(1)
+    {
+        unsigned int low, high;
+        int used;
+        if(sscanf(field, "%u-%u%n", &low, &high, &used) == 2 && low > 0 && low <= high)
+        {
+            // Power of Two Steps
+            unsigned long value;
+            for(value = low; value <= high && count < MAX_SWEEP_VALUES; value *= 2)
+                values[count++] = value;
+        }
+        else if(sscanf(field, "%u%n", &low, &used) == 1 && low > 0 && count < MAX_SWEEP_VALUES)
+        {
+            values[count++] = low;
+        }
+        else
+        {
+            return 0;
+        }
+
+        field += used;
+        if(*field != ',')
+            return (*field == ':' || *field == '\0') ? count : 0;
+        field++;
+    }
+}
+
+SweepJob* parseSweep(const char* spec, unsigned int* count)
+{
+    unsigned int blockSizes[MAX_SWEEP_VALUES], sets[MAX_SWEEP_VALUES], ways[MAX_SWEEP_VALUES];
+    const char* setField = strchr(spec, ':');
+    const char* wayField = setField ? strchr(setField + 1, ':') : NULL;
+    if(!wayField)
+        return NULL;
+
+    int blockCount = parseSweepField(spec, blockSizes);
+    int setCount = parseSweepField(setField + 1, sets);
+    int wayCount = parseSweepField(wayField + 1, ways);
+    if(!blockCount || !setCount || !wayCount)
+        return NULL;
+
+    *count = blockCount * setCount * wayCount;
+    SweepJob* jobs = (SweepJob*)calloc(*count, sizeof(SweepJob));
+    int b, s, w;
+    unsigned int j = 0;
+    for(b = 0; b < blockCount; b++)
+    {
+        for(s = 0; s < setCount; s++)
+        {
+            for(w = 0; w < wayCount; w++)
+            {
+                // Block Sizes and Set Counts Must Be Powers of Two to Split the Address
+                if((blockSizes[b] & (blockSizes[b] - 1)) || (sets[s] & (sets[s] - 1)))
+                {
+                    free(jobs);
+                    return NULL;
+                }
+                jobs[j].geometry.blockSize = blockSizes[b];
+                jobs[j].geometry.numSets = sets[s];
+                jobs[j].geometry.associativity = ways[w];
+                jobs[j].geometry.addressBits = OPTIONS.addressBits;
+                jobs[j].geometry.indexing = OPTIONS.indexing->id;
+                if(!calculateAddressBits(&jobs[j].geometry))
+                {
+                    free(jobs);
+                    return NULL;
+                }
+                j++;
+            }
+        }
+    }
+    return jobs;
+}
+
+/**
+ * @brief Take a job from a worker's own queue, or steal one from another worker's queue.
+ * @param SweepPool* pool Pool to take from.
+ * @param unsigned int id Worker taking the job.
+ * @return long Index of the job, -1 once every queue is empty.
+ */
+static long takeSweepJob(SweepPool* pool, unsigned int id)
+{
+    unsigned int k;
+    for(k = 0; k < pool->workers; k++)
+    {
+        WorkQueue* queue = &pool->queues[(id + k) % pool->workers];
+        long job = -1;
+        pthread_mutex_lock(&queue->lock);
+        if(queue->head < queue->tail)
+        {
+            if(k == 0)
+                job = queue->jobs[--queue->tail];
+            else
+                job = queue->jobs[queue->head++];
+        }
+        pthread_mutex_unlock(&queue->lock);
+        if(job >= 0)
+            return job;
+    }
+    return -1;
+}
+
+/**
+ * @brief Sweep pool thread, simulates jobs until there are none left to take or steal.
+ * @param void* arg The worker.
+ * @return void* NULL
+ */
+static void* sweepWorker(void* arg)
+{
+    SweepWorker* worker = (SweepWorker*)arg;
+    int count = strlen(OPTIONS.policies);
+    long j;
+    while((j = takeSweepJob(worker->pool, worker->id)) >= 0)
+    {
+        SweepJob* job = &worker->pool->jobs[j];
+        int c;
+        for(c = 0; c < count; c++)
+        {
+            Cache* cache = initCache(&job->geometry, findWritePolicy(OPTIONS.policies[c]), OPTIONS.replacement);
+            if(OPTIONS.prefetcher)
+                setPrefetcher(cache, OPTIONS.prefetcher);
+            if(OPTIONS.victimKind)
+                setVictimCache(cache, OPTIONS.victimKind, OPTIONS.victimEntries);
+            if(OPTIONS.classify)
+                setClassifier(cache);
+            simulate(cache);
+            job->hits[c] = cache->hits;
+            job->misses[c] = cache->misses;
+            job->memrefs[c] = cache->memrefs;
+            deinitCache(cache);
+        }
+    }
+    return NULL;
+}
+
+void runSweep(SweepJob* jobs, unsigned int count, unsigned int threads)
+{
+    SweepPool pool;
+    pool.jobs = jobs;
+    pool.workers = threads;
+    pool.queues = (WorkQueue*)calloc(threads, sizeof(WorkQueue));
+    SweepWorker* workers = (SweepWorker*)calloc(threads, sizeof(SweepWorker));
+
+    // Deal the Jobs Out Round Robin, Stealing Evens Out the Rest
+    unsigned int w;
+    for(w = 0; w < threads; w++)
+    {
+        pthread_mutex_init(&pool.queues[w].lock, NULL);
+        pool.queues[w].jobs = (unsigned int*)malloc(sizeof(unsigned int) * (count / threads + 1));
+    }
+    unsigned int j;
+    for(j = 0; j < count; j++)
+    {
+        WorkQueue* queue = &pool.queues[j % threads];
+        queue->jobs[queue->tail++] = j;
+    }
+
+    for(w = 0; w < threads; w++)
+    {
+        workers[w].pool = &pool;
+        workers[w].id = w;
+        pthread_create(&workers[w].thread, NULL, sweepWorker, &workers[w]);
+    }
+    for(w = 0; w < threads; w++)
+    {
+        pthread_join(workers[w].thread, NULL);
+        pthread_mutex_destroy(&pool.queues[w].lock);
+        free(pool.queues[w].jobs);
+    }
+    free(pool.queues);
+    free(workers);
+}
+
+void printSweep(SweepJob* jobs, unsigned int count, char format)
+{
+    int policies = strlen(OPTIONS.policies);
+    unsigned long references = LINE_LIST->size;
+    if(format == 'j')
+        printf("[\n");
+    else
+        printf("Block Size,Sets,Associativity,Replacement,Policy,References,Hits,Misses,Memory References,Miss Ratio\n");
+
+    unsigned int j;
+    for(j = 0; j < count; j++)
+    {
+        int c;
+        for(c = 0; c < policies; c++)
+        {
+            const Geometry* geometry = &jobs[j].geometry;
+            const char* name = findWritePolicy(OPTIONS.policies[c])->name;
+            double ratio = references ? (double)jobs[j].misses[c] / references : 0.0;
+            if(format == 'j')
+            {
+                printf("  {\"blockSize\": %u, \"sets\": %u, \"associativity\": %u, \"replacement\": \"%s\", \"policy\": \"%s\", "
+                       "\"references\": %lu, \"hits\": %lu, \"misses\": %lu, \"memoryReferences\": %lu, \"missRatio\": %.6f}%s\n",
+                       geometry->blockSize, geometry->numSets, geometry->associativity, OPTIONS.replacement->name, name, references,
+                       jobs[j].hits[c], jobs[j].misses[c], jobs[j].memrefs[c], ratio,
+                       (j + 1 < count || c + 1 < policies) ? "," : "");
+            }
+            else
+            {
+                printf("%u,%u,%u,%s,%s,%lu,%lu,%lu,%lu,%.6f\n", geometry->blockSize, geometry->numSets, geometry->associativity,
+                       OPTIONS.replacement->name, name, references, jobs[j].hits[c], jobs[j].misses[c], jobs[j].memrefs[c], ratio);
+            }
+        }
+    }
+
+    if(format == 'j')
+        printf("]\n");
+}
+
+void runBenchmark(SweepJob* jobs, unsigned int count, unsigned int repeats)
+{
+    int policies = strlen(OPTIONS.policies);
+    unsigned int j;
+    for(j = 0; j < count; j++)
+    {
+        int c;
+        for(c = 0; c < policies; c++)
+        {
+            unsigned int r;
+            for(r = 0; r < repeats; r++)
+            {
+                // Only the Pass Itself is Timed, Not Building the Cache
+                Cache* cache = initCache(&jobs[j].geometry, findWritePolicy(OPTIONS.policies[c]), OPTIONS.replacement);
+                if(OPTIONS.prefetcher)
+                    setPrefetcher(cache, OPTIONS.prefetcher);
+                if(OPTIONS.victimKind)
+                    setVictimCache(cache, OPTIONS.victimKind, OPTIONS.victimEntries);
+                if(OPTIONS.classify)
+                    setClassifier(cache);
+                struct timespec start, stop;
+                clock_gettime(CLOCK_MONOTONIC, &start);
+                simulate(cache);
+                clock_gettime(CLOCK_MONOTONIC, &stop);
+                double seconds = (stop.tv_sec - start.tv_sec) + (stop.tv_nsec - start.tv_nsec) * 1e-9;
+                if(r == 0 || seconds < jobs[j].seconds[c])
+                    jobs[j].seconds[c] = seconds;
+                jobs[j].hits[c] = cache->hits;
+                jobs[j].misses[c] = cache->misses;
+                jobs[j].memrefs[c] = cache->memrefs;
+                deinitCache(cache);
+            }
+        }
+    }
+}
+
+Baseline* loadBaseline(const char* path, unsigned int* count)
+{
+    FILE* file = fopen(path, "r");
+    if(!file)
+        return NULL;
+
+    unsigned int capacity = 64;
+    Baseline* rows = (Baseline*)malloc(sizeof(Baseline) * capacity);
+    char line[512];
+    *count = 0;
+    while(fgets(line, sizeof(line), file))
+    {
+        // The Header and Any Malformed Rows Fail to Scan and Are Skipped
+        Baseline row;
+        unsigned long references;
+        double seconds;
+        if(sscanf(line, "%u,%u,%u,%15[^,],%63[^,],%lu,%lf,%lf", &row.blockSize, &row.numSets, &row.associativity,
+                  row.replacement, row.policy, &references, &seconds, &row.rate) != 8)
+            continue;
+        if(*count == capacity)
+        {
+            capacity *= 2;
+            rows = (Baseline*)realloc(rows, sizeof(Baseline) * capacity);
+        }
+        rows[(*count)++] = row;
+    }
+    fclose(file);
+    return rows;
+}
+
+unsigned int printBenchmark(SweepJob* jobs, unsigned int count, const Baseline* baseline, unsigned int baselineCount, double tolerance)
+{
+    int policies = strlen(OPTIONS.policies);
+    unsigned long references = LINE_LIST->size;
+    printf("Block Size,Sets,Associativity,Replacement,Policy,References,Seconds,References per Second%s\n",
+           baseline ? ",Baseline,Change,Status" : "");
+
+    unsigned int regressions = 0;
+    unsigned int j;
+    for(j = 0; j < count; j++)
+    {
+        int c;
+        for(c = 0; c < policies; c++)
+        {
+            const Geometry* geometry = &jobs[j].geometry;
+            const char* name = findWritePolicy(OPTIONS.policies[c])->name;
+            double rate = jobs[j].seconds[c] > 0.0 ? references / jobs[j].seconds[c] : 0.0;
+            printf("%u,%u,%u,%s,%s,%lu,%.6f,%.0f", geometry->blockSize, geometry->numSets, geometry->associativity,
+                   OPTIONS.replacement->name, name, references, jobs[j].seconds[c], rate);
+            if(!baseline)
+            {
+                printf("\n");
+                continue;
+            }
+
+            const Baseline* row = NULL;
+            unsigned int b;
+            for(b = 0; b < baselineCount && !row; b++)
+            {
+                if(baseline[b].blockSize == geometry->blockSize && baseline[b].numSets == geometry->numSets &&
+                   baseline[b].associativity == geometry->associativity &&
+                   strcmp(baseline[b].replacement, OPTIONS.replacement->name) == 0 && strcmp(baseline[b].policy, name) == 0)
+                    row = &baseline[b];
+            }
+            if(!row || row->rate <= 0.0)
+            {
+                printf(",,,new\n");
+                continue;
+            }
+
+            int regressed = rate < row->rate * (1.0 - tolerance);
+            regressions += regressed;
+            printf(",%.0f,%+.1f%%,%s\n", row->rate, (rate / row->rate - 1.0) * 100.0, regressed ? "REGRESSION" : "ok");
+        }
+    }
+    return regressions;
+}
+
+int parseWorkload(const char* spec, Workload* workload)
+{
+    static const char* const UNITS = "KMG";
+    workload->references = 0;
+    workload->footprint = 1 << 20;
+    workload->writes = 0.3;
+    workload->seed = 1;
+    workload->stride = 256;
+    workload->alpha = 0.99;
+
+    char name[8];
+    int used;
+    if(sscanf(spec, "%7[a-z]%n", name, &used) != 1)
+        return 0;
+    spec += used;
+    if(strcmp(name, "seq") == 0)
+        workload->kind = 's';
+    else if(strcmp(name, "stride") == 0)
+        workload->kind = 't';
+    else if(strcmp(name, "random") == 0)
+        workload->kind = 'r';
+    else if(strcmp(name, "zipf") == 0)
+        workload->kind = 'z';
+    else if(strcmp(name, "chase") == 0)
+        workload->kind = 'c';
+    else if(strcmp(name, "mix") == 0)
+        workload->kind = 'm';
+    else
+        return 0;
+
+    // Only Strided and Zipfian Workloads Take a Parameter
+    if(*spec == '=')
+    {
+        if(workload->kind == 't' && sscanf(spec, "=%u%n", &workload->stride, &used) == 1 && workload->stride > 0)
+            spec += used;
+        else if(workload->kind == 'z' && sscanf(spec, "=%lf%n", &workload->alpha, &used) == 1 && workload->alpha >= 0.0)
+            spec += used;
+        else
+            return 0;
+    }
+
+    if(sscanf(spec, ":%lu%n", &workload->references, &used) != 1)
+        return 0;
+    spec += used;
+    if(*spec == ':')
+    {
+        unsigned long long footprint;
+        if(sscanf(spec, ":%llu%n", &footprint, &used) != 1)
+            return 0;
+        spec += used;
+        const char* unit = *spec ? strchr(UNITS, *spec) : NULL;
+        if(unit)
+        {
+            footprint <<= 10 * (unit - UNITS + 1);
+            spec++;
+        }
+        workload->footprint = footprint;
+    }
+    if(*spec == ':')
+    {
+        if(sscanf(spec, ":%lf%n", &workload->writes, &used) != 1)
+            return 0;
+        spec += used;
+    }
+    if(*spec == ':')
+    {
+        unsigned long long seed;
+        if(sscanf(spec, ":%llu%n", &seed, &used) != 1)
+            return 0;
+        workload->seed = seed;
+        spec += used;
+    }
+
+    // Blocks are Numbered in 32 Bits by the Zipfian and Pointer Chase Tables
+    return *spec == '\0' && workload->writes >= 0.0 && workload->writes <= 1.0 &&
+           workload->footprint >= WORKLOAD_GRAIN && workload->footprint / WORKLOAD_GRAIN <= UINT32_MAX;
+}
+
+/**
+ * @brief Advance a splitmix64 generator.
+ * @param uint64_t* state State of the generator.
+ * @return uint64_t The next random value.
+ */
+static uint64_t nextRandom(uint64_t* state)
+{
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+/**
+ * @brief Draw a uniform random fraction.
+ * @param uint64_t* state State of the generator.
+ * @return double A value in [0, 1).
+ */
+static double randomFraction(uint64_t* state)
+{
+    return (nextRandom(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+int generateWorkload(const Workload* workload, FILE* out)
+{
+    uint64_t state = workload->seed;
+    uint64_t words = workload->footprint / WORD_BYTES;
+    uint32_t blocks = workload->footprint / WORKLOAD_GRAIN;
+    double* popularity = NULL;
+    uint32_t* next = NULL;
+
+    // Zipfian Ranks are Drawn From the Cumulative Popularity of Every Block
+    if(workload->kind == 'z' || workload->kind == 'm')
+    {
+        if(!(popularity = (double*)malloc(sizeof(double) * blocks)))
+        {
+            fprintf(stderr, "Workload footprint too large\n");
+            return 0;
+        }
+        double total = 0.0;
+        uint32_t k;
+        for(k = 0; k < blocks; k++)
+            popularity[k] = (total += pow(k + 1.0, -workload->alpha));
+        for(k = 0; k < blocks; k++)
+            popularity[k] /= total;
+        popularity[blocks - 1] = 1.0;
+    }
+
+    // Sattolo's Shuffle Links Every Node Into a Single Cycle, so the Chase Visits Them All Before Repeating
+    if(workload->kind == 'c' || workload->kind == 'm')
+    {
+        if(!(next = (uint32_t*)malloc(sizeof(uint32_t) * blocks)))
+        {
+            fprintf(stderr, "Workload footprint too large\n");
+            free(popularity);
+            return 0;
+        }
+        uint32_t k;
+        for(k = 0; k < blocks; k++)
+            next[k] = k;
+        for(k = blocks - 1; k > 0; k--)
+        {
+            uint32_t other = nextRandom(&state) % k;
+            uint32_t swap = next[k];
+            next[k] = next[other];
+            next[other] = swap;
+        }
+    }
+
+    fprintf(out, "%u\n%u\n%u\n", WORKLOAD_BLOCK_SIZE, WORKLOAD_SETS, WORKLOAD_ASSOCIATIVITY);
+    uint64_t sequential = 0, strided = 0;
+    uint32_t node = 0;
+    unsigned long i;
+    for(i = 0; i < workload->references; i++)
+    {
+        // Mixed Workloads Draw Each Reference From One of the Other Patterns
+        char kind = workload->kind;
+        if(kind == 'm')
+        {
+            double pick = randomFraction(&state);
+            kind = pick < 0.4 ? 's' : pick < 0.6 ? 't' : pick < 0.8 ? 'z' : pick < 0.9 ? 'c' : 'r';
+        }
+
+        uint64_t address;
+        if(kind == 's')
+        {
+            address = (sequential++ % words) * WORD_BYTES;
+        }
+        else if(kind == 't')
+        {
+            // Each Pass Over the Footprint Shifts by a Word, Reaching New Words of the Same Blocks
+            uint64_t offset = strided++ * workload->stride;
+            address = (offset % workload->footprint + offset / workload->footprint * WORD_BYTES) % workload->footprint;
+        }
+        else if(kind == 'r')
+        {
+            address = nextRandom(&state) % words * WORD_BYTES;
+        }
+        else if(kind == 'z')
+        {
+            // Scatter the Ranks so the Popular Blocks Spread Over the Sets
+            double draw = randomFraction(&state);
+            uint32_t low = 0, high = blocks - 1;
+            while(low < high)
+            {
+                uint32_t middle = low + (high - low) / 2;
+                if(popularity[middle] > draw)
+                    high = middle;
+                else
+                    low = middle + 1;
+            }
+            uint64_t block = (uint64_t)low * WORKLOAD_SCATTER % blocks;
+            address = block * WORKLOAD_GRAIN + nextRandom(&state) % (WORKLOAD_GRAIN / WORD_BYTES) * WORD_BYTES;
+        }
+        else
+        {
+            node = next[node];
+            address = (uint64_t)node * WORKLOAD_GRAIN;
+        }
+
+        char operation = randomFraction(&state) < workload->writes ? 'W' : 'R';
+        fprintf(out, "%c %llu\n", operation, (unsigned long long)address);
+    }
+
+    free(popularity);
+    free(next);
+    return 1;
+}
+
+StackDistance* initStackDistance(unsigned int indexBits, unsigned int depth)
+{
+    StackDistance* engine = (StackDistance*)malloc(sizeof(StackDistance));
+    engine->indexBits = indexBits;
+    engine->depth = depth;
+    engine->stacks = (uint64_t*)malloc(sizeof(uint64_t) * ((size_t)depth << indexBits));
+    engine->sizes = (unsigned int*)calloc((size_t)1 << indexBits, sizeof(unsigned int));
+    engine->histogram = (unsigned long*)calloc(depth, sizeof(unsigned long));
+    engine->references = 0;
+    engine->seed = 0;
+    engine->sampleShift = 0;
+    return engine;
+}
+
+void deinitStackDistance(StackDistance* engine)
+{
+    free(engine->stacks);
+    free(engine->sizes);
+    free(engine->histogram);
+    free(engine);
+}
+
+void stackDistanceAccess(StackDistance* engine, uint64_t block)
+{
+    unsigned int set = block & ((1u << engine->indexBits) - 1);
+    uint64_t* stack = &engine->stacks[(size_t)set * engine->depth];
+    unsigned int size = engine->sizes[set];
+    engine->references += 1;
+
+    // Find the Block's Depth, Blocks Deeper Than the Largest Associativity Miss Everywhere
+    unsigned int distance = 0;
+    while(distance < size && stack[distance] != block)
+        distance++;
+
+    if(distance < size)
+    {
+        engine->histogram[distance] += 1;
+    }
+    else if(size < engine->depth)
+    {
+        engine->sizes[set] = size + 1;
+    }
+    else
+    {
+        distance = size - 1;
+    }
+
+    // Move to the Top of the Stack
+    memmove(&stack[1], &stack[0], sizeof(uint64_t) * distance);
+    stack[0] = block;
+}
+
+unsigned long simulateStackDistance(TraceReader* reader, StackDistance** engines, int count)
+{
+    Line lines[TRACE_BATCH_SIZE];
+    unsigned long references = 0;
+    unsigned int size;
+    while((size = readTraceBatch(reader, lines, TRACE_BATCH_SIZE)) > 0)
+    {
+        int e;
+        for(e = 0; e < count; e++)
+        {
+            unsigned int i;
+            if(engines[e]->sampleShift)
+            {
+                for(i = 0; i < size; i++)
+                {
+                    uint64_t block = lines[i].address >> GEOMETRY.offsetBits;
+                    if(sampleBlock(block, engines[e]->seed, engines[e]->sampleShift))
+                        stackDistanceAccess(engines[e], block);
+                }
+                continue;
+            }
+            for(i = 0; i < size; i++)
+            {
+                stackDistanceAccess(engines[e], lines[i].address >> GEOMETRY.offsetBits);
+            }
+        }
+        references += size;
+    }
+    return references;
+}
+
+void printMissRatioCurve(StackDistance** engines, int count, unsigned long references)
+{
+    char* div = "****************************************\n";
+    printf("%s",div);
+    printf("LRU Miss-Ratio Curve with Write Allocate\n");
+    printf("%s",div);
+    printf("Total number of references: %lu\n", references);
+    printf("Sets,Associativity,Capacity,Misses,Miss Ratio\n");
+
+    int e;
+    for(e = 0; e < count; e++)
+    {
+        // Misses at Associativity A are the References Deeper Than A in the Stack
+        unsigned long misses = references;
+        unsigned int ways;
+        for(ways = 1; ways <= engines[e]->depth; ways++)
+        {
+            misses -= engines[e]->histogram[ways - 1];
+            unsigned int sets = 1u << engines[e]->indexBits;
+            printf("%u,%u,%lu,%lu,%.6f\n", sets, ways, (unsigned long)sets * ways * GEOMETRY.blockSize, misses,
+                   references ? (double)misses / references : 0.0);
+        }
+    }
+}
+
+int sampleBlock(uint64_t block, unsigned int seed, unsigned int shift)
+{
+    // Murmur3 Finalizer Over the Seeded Block (Folded to 32 Bits), Keep Hashes Whose Top Bits are Zero
+    uint32_t hash = (uint32_t)(block ^ (block >> 32)) ^ (seed * 0x9E3779B9u);
+    hash ^= hash >> 16;
+    hash *= 0x85EBCA6Bu;
+    hash ^= hash >> 13;
+    hash *= 0xC2B2AE35u;
+    hash ^= hash >> 16;
+    return shift == 0 || (hash >> (32 - shift)) == 0;
+}
+
+Geometry scaleGeometry(const Geometry* geometry, unsigned int shift)
+{
+    Geometry scaled = *geometry;
+    scaled.numSets = geometry->numSets >> shift;
+    calculateAddressBits(&scaled);
+    return scaled;
+}
+
+unsigned long simulateSampled(TraceReader* reader, Cache** caches, int count, unsigned int seeds, unsigned int shift)
+{
+    Line lines[TRACE_BATCH_SIZE];
+    unsigned long references = 0;
+    unsigned int size;
+    while((size = readTraceBatch(reader, lines, TRACE_BATCH_SIZE)) > 0)
+    {
+        unsigned int seed;
+        for(seed = 0; seed < seeds; seed++)
+        {
+            unsigned int i;
+            for(i = 0; i < size; i++)
+            {
+                if(!sampleBlock(lines[i].address >> GEOMETRY.offsetBits, seed + 1, shift))
+                    continue;
+                int c;
+                for(c = 0; c < count; c++)
+                    cacheLine(caches[seed * count + c], &lines[i]);
+            }
+        }
+        references += size;
+    }
+    return references;
+}
+
+/**
+ * @brief Summarize independent estimates by their mean and the half width of its 95% confidence interval.
+ * @param const double* samples The estimates.
+ * @param unsigned int count Number of estimates, at least 2.
+ * @param double* mean Destination of the mean.
+ * @return double Half width of the Student t interval.
+ */
+static double confidenceInterval(const double* samples, unsigned int count, double* mean)
+{
+    // Two Sided 97.5% Quantiles of Student's t, by Degrees of Freedom
+    static const double t[MAX_SEEDS] = {0.0, 12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365,
+                                        2.306, 2.262, 2.228, 2.201, 2.179, 2.160, 2.145, 2.131};
+    double sum = 0.0;
+    unsigned int i;
+    for(i = 0; i < count; i++)
+        sum += samples[i];
+    *mean = sum / count;
+
+    double squares = 0.0;
+    for(i = 0; i < count; i++)
+        squares += (samples[i] - *mean) * (samples[i] - *mean);
+    return t[count - 1] * sqrt(squares / (count - 1) / count);
+}
+
+void printSampledReport(Cache** caches, int count, unsigned int seeds, unsigned int shift, unsigned long references)
+{
+    char* div = "****************************************\n";
+    int c;
+    for(c = 0; c < count; c++)
+    {
+        double hitRatios[MAX_SEEDS], missRatios[MAX_SEEDS], memrefs[MAX_SEEDS], sampled[MAX_SEEDS];
+        unsigned int seed;
+        for(seed = 0; seed < seeds; seed++)
+        {
+            Cache* cache = caches[seed * count + c];
+            double total = cache->cacheReferences;
+            hitRatios[seed] = total ? cache->hits / total : 0.0;
+            missRatios[seed] = total ? cache->misses / total : 0.0;
+            memrefs[seed] = (double)cache->memrefs * (1u << shift);
+            sampled[seed] = total;
+        }
+
+        double mean;
+        printf("%s", div);
+        printf("%s\n", caches[c]->policy->name);
+        printf("%s", div);
+        printf("Total number of references: %lu\n", references);
+        confidenceInterval(sampled, seeds, &mean);
+        printf("Sampled references: %.0f per sample (1/%u of the blocks, %u samples)\n", mean, 1u << shift, seeds);
+        double error = confidenceInterval(hitRatios, seeds, &mean);
+        printf("Hit Ratio: %.6f +/- %.6f\n", mean, error);
+        error = confidenceInterval(missRatios, seeds, &mean);
+        printf("Miss Ratio: %.6f +/- %.6f\n", mean, error);
+        error = confidenceInterval(memrefs, seeds, &mean);
+        printf("Memory References: %.0f +/- %.0f\n", mean, error);
+    }
+}
+
+void printSampledMissRatioCurve(StackDistance** engines, int count, unsigned int seeds, unsigned long references)
+{
+    char* div = "****************************************\n";
+    printf("%s",div);
+    printf("Sampled LRU Miss-Ratio Curve with Write Allocate\n");
+    printf("%s",div);
+    printf("Total number of references: %lu\n", references);
+    printf("Sampling rate: 1/%u of the blocks, %u samples\n", 1u << engines[0]->sampleShift, seeds);
+    printf("Sets,Associativity,Capacity,Miss Ratio,Error\n");
+
+    int e;
+    for(e = 0; e < count; e++)
+    {
+        StackDistance** samples = &engines[e * seeds];
+        unsigned long misses[MAX_SEEDS];
+        unsigned int seed;
+        for(seed = 0; seed < seeds; seed++)
+            misses[seed] = samples[seed]->references;
+
+        unsigned int ways;
+        for(ways = 1; ways <= samples[0]->depth; ways++)
+        {
+            double ratios[MAX_SEEDS];
+            for(seed = 0; seed < seeds; seed++)
+            {
+                misses[seed] -= samples[seed]->histogram[ways - 1];
+                ratios[seed] = samples[seed]->references ? (double)misses[seed] / samples[seed]->references : 0.0;
+            }
+
+            // Each Sampled Set Stands for 2^sampleShift Sets of the Full Cache
+            double mean;
+            double error = confidenceInterval(ratios, seeds, &mean);
+            unsigned int sets = 1u << (samples[0]->indexBits + samples[0]->sampleShift);
+            printf("%u,%u,%lu,%.6f,%.6f\n", sets, ways, (unsigned long)sets * ways * GEOMETRY.blockSize, mean, error);
+        }
+    }
+}
+
+Hierarchy* initHierarchy(const char** specs, int count)
+{
+    Hierarchy* hierarchy = (Hierarchy*)calloc(1, sizeof(Hierarchy));
+    int k;
+    for(k = 0; k < count; k++)
+    {
+        Geometry geometry = {0};
+        char policy;
+        char inclusion = 'n';
+        int used = 0;
+        const WritePolicy* writePolicy;
+        if(sscanf(specs[k], "%u:%u:%u:%c%n", &geometry.blockSize, &geometry.numSets, &geometry.associativity, &policy, &used) != 4 ||
+           !(writePolicy = findWritePolicy(policy)))
+            break;
+        if(specs[k][used] == ':' && specs[k][used + 1] && strchr("ien", specs[k][used + 1]) && specs[k][used + 2] == '\0')
+            inclusion = specs[k][used + 1];
+        else if(specs[k][used] != '\0')
+            break;
+
+        // Block Sizes and Set Counts Must Be Powers of Two, and Blocks May Only Grow Away From the Processor
+        if(!geometry.blockSize || (geometry.blockSize & (geometry.blockSize - 1)) ||
+           !geometry.numSets || (geometry.numSets & (geometry.numSets - 1)) || !geometry.associativity ||
+           !supportsReplacement(&geometry, OPTIONS.replacement))
+            break;
+        if(k > 0 && geometry.blockSize < hierarchy->levels[k - 1].cache->geometry.blockSize)
+            break;
+
+        // The First Level Holds Everything Accessed, and Exclusive Levels Trade Whole Blocks With the Level Above
+        if(k == 0)
+            inclusion = 'n';
+        else if(inclusion == 'e' && geometry.blockSize != hierarchy->levels[k - 1].cache->geometry.blockSize)
+            break;
+
+        geometry.addressBits = OPTIONS.addressBits;
+        geometry.indexing = OPTIONS.indexing->id;
+        if(!calculateAddressBits(&geometry))
+            break;
+        hierarchy->levels[k].cache = initCache(&geometry, writePolicy, OPTIONS.replacement);
+        hierarchy->levels[k].inclusion = inclusion;
+        hierarchy->count++;
+    }
+
+    if(hierarchy->count != count)
+    {
+        deinitHierarchy(hierarchy);
+        return NULL;
+    }
+    return hierarchy;
+}
+
+void deinitHierarchy(Hierarchy* hierarchy)
+{
+    int k;
+    for(k = 0; k < hierarchy->count; k++)
+        deinitCache(hierarchy->levels[k].cache);
+    free(hierarchy);
+}
+
+/**
+ * @brief Remove a block from a cache if it is present.
+ * @param Cache* cache Cache to remove from.
+ * @param uint64_t address Any address within the block.
+ * @return int -1 if the block was absent, otherwise 1 if it was dirty and 0 if it was clean.
+ */
+static int invalidateBlock(Cache* cache, uint64_t address)
+{
+    unsigned int index = getIndexBits(&cache->geometry, address);
+    int way = findWay(cache, index, getTagBits(&cache->geometry, address));
+    if(way < 0)
+        return -1;
+
+    uint64_t* dirty = &cache->dirty[(size_t)index * cache->maskWords];
+    int wasDirty = testWay(dirty, way);
+    clearWay(&cache->valid[(size_t)index * cache->maskWords], way);
+    clearWay(dirty, way);
+    return wasDirty;
+}
+
+static void hierarchyWrite(Hierarchy* hierarchy, int k, uint64_t address, char writeback);
+
+/**
+ * @brief Hand a block evicted from a level to the level below it.
+ * @param Hierarchy* hierarchy Hierarchy of the block.
+ * @param int k Level receiving the block (the hierarchy's count for memory).
+ * @param uint64_t address Any address within the block.
+ * @param int dirty Indicates the block was modified.
+ * @return void
+ */
+static void hierarchyEvict(Hierarchy* hierarchy, int k, uint64_t address, int dirty);
+
+/**
+ * @brief Place a block into a level, evicting the replacement policy's victim if its set is full.
+ * @param Hierarchy* hierarchy Hierarchy of the level.
+ * @param int k Level to fill.
+ * @param uint64_t address Any address within the block.
+ * @param int dirty Indicates the block arrives modified.
+ * @return void
+ */
+static void hierarchyInstall(Hierarchy* hierarchy, int k, uint64_t address, int dirty)
+{
+    Level* level = &hierarchy->levels[k];
+    Cache* cache = level->cache;
+    const Geometry* geometry = &cache->geometry;
+    unsigned int index = getIndexBits(geometry, address);
+    size_t base = (size_t)index * geometry->associativity;
+    uint64_t* dirtyWays = &cache->dirty[(size_t)index * cache->maskWords];
+    unsigned char* state = &cache->state[(size_t)index * cache->stateBytes];
+
+    int way = findFreeWay(cache, index);
+    int evicted = way < 0;
+    uint64_t victim = 0;
+    int victimDirty = 0;
+    if(evicted)
+    {
+        way = cache->replacement->victim(state, geometry->associativity);
+        victim = blockOfWay(cache, index, way) << geometry->offsetBits;
+        victimDirty = testWay(dirtyWays, way);
+    }
+
+    // Fill Before Evicting, so the Victim's Journey Down Cannot Disturb the Incoming Block's Way
+    storeTag(cache, cache->tags, base + way, getTagBits(geometry, address));
+    setWay(&cache->valid[(size_t)index * cache->maskWords], way);
+    if(dirty)
+        setWay(dirtyWays, way);
+    else
+        clearWay(dirtyWays, way);
+    cache->replacement->fill(state, geometry->associativity, way);
+    if(!evicted)
+        return;
+
+    // Keep the Levels Above Included, Merging Their Modifications Into the Victim
+    if(level->inclusion == 'i')
+    {
+        int upper;
+        for(upper = 0; upper < k; upper++)
+        {
+            unsigned int step = hierarchy->levels[upper].cache->geometry.blockSize;
+            unsigned int offset;
+            for(offset = 0; offset < geometry->blockSize; offset += step)
+            {
+                int wasDirty = invalidateBlock(hierarchy->levels[upper].cache, victim + offset);
+                if(wasDirty >= 0)
+                {
+                    level->invalidations += 1;
+                    victimDirty |= wasDirty;
+                }
+            }
+        }
+    }
+
+    if(victimDirty)
+        level->writebacks += 1;
+    hierarchyEvict(hierarchy, k + 1, victim, victimDirty);
+}
+
+static void hierarchyEvict(Hierarchy* hierarchy, int k, uint64_t address, int dirty)
+{
+    if(k == hierarchy->count)
+    {
+        if(dirty)
+        {
+            hierarchy->levels[k - 1].cache->memrefs += 1;
+            hierarchy->memoryWrites += 1;
+        }
+        return;
+    }
+
+    // Exclusive Levels are Filled Only by the Victims of the Level Above, Clean or Not
+    if(hierarchy->levels[k].inclusion == 'e')
+    {
+        hierarchy->levels[k - 1].cache->memrefs += 1;
+        int wasDirty = invalidateBlock(hierarchy->levels[k].cache, address);
+        hierarchyInstall(hierarchy, k, address, dirty || wasDirty > 0);
+    }
+    else if(dirty)
+    {
+        hierarchy->levels[k - 1].cache->memrefs += 1;
+        hierarchyWrite(hierarchy, k, address, 1);
+    }
+}
+
+/**
+ * @brief Read a block through a level on behalf of the level above (or the processor).
+ * @param Hierarchy* hierarchy Hierarchy to read.
+ * @param int k Level to read (the hierarchy's count for memory).
+ * @param uint64_t address Address to read.
+ * @return int 1 if an exclusive level handed up a modified block, 0 otherwise.
+ */
+static int hierarchyRead(Hierarchy* hierarchy, int k, uint64_t address)
+{
+    if(k == hierarchy->count)
+    {
+        hierarchy->memoryReads += 1;
+        return 0;
+    }
+
+    Level* level = &hierarchy->levels[k];
+    Cache* cache = level->cache;
+    cache->cacheReferences += 1;
+    unsigned int index = getIndexBits(&cache->geometry, address);
+    int way = findWay(cache, index, getTagBits(&cache->geometry, address));
+    if(way > -1)
+    {
+        cache->hits += 1;
+
+        // Exclusive Hits Move the Block (and its Modifications) Up
+        if(level->inclusion == 'e')
+            return invalidateBlock(cache, address);
+        cache->replacement->touch(&cache->state[(size_t)index * cache->stateBytes], cache->geometry.associativity, way);
+        return 0;
+    }
+
+    cache->misses += 1;
+    cache->memrefs += 1;
+    cache->fetches += 1;
+    int dirty = hierarchyRead(hierarchy, k + 1, address);
+    if(level->inclusion == 'e')
+        return dirty;
+    hierarchyInstall(hierarchy, k, address, dirty);
+    return 0;
+}
+
+/**
+ * @brief Write through a level, either a store from the level above or a writeback of a whole block.
+ * @param Hierarchy* hierarchy Hierarchy to write.
+ * @param int k Level to write (the hierarchy's count for memory).
+ * @param uint64_t address Address to write.
+ * @param char writeback Indicates a whole block is written, so allocating it needs no fetch.
+ * @return void
+ */
+static void hierarchyWrite(Hierarchy* hierarchy, int k, uint64_t address, char writeback)
+{
+    if(k == hierarchy->count)
+    {
+        hierarchy->memoryWrites += 1;
+        return;
+    }
+
+    Level* level = &hierarchy->levels[k];
+    Cache* cache = level->cache;
+    cache->cacheReferences += 1;
+    unsigned int index = getIndexBits(&cache->geometry, address);
+    int way = findWay(cache, index, getTagBits(&cache->geometry, address));
+    if(way > -1)
+    {
+        // Write Hit
+        cache->hits += 1;
+        cache->replacement->touch(&cache->state[(size_t)index * cache->stateBytes], cache->geometry.associativity, way);
+        if(cache->policy->writeBack)
+            setWay(&cache->dirty[(size_t)index * cache->maskWords], way);
+        else
+        {
+            cache->memrefs += 1;
+            hierarchyWrite(hierarchy, k + 1, address, writeback);
+        }
+        return;
+    }
+
+    cache->misses += 1;
+    if(cache->policy->writeAllocate && level->inclusion != 'e')
+    {
+        // Allocating Write Miss, Fetch the Rest of the Block Unless the Whole Block is Written
+        int dirty = 0;
+        if(!writeback)
+        {
+            cache->memrefs += 1;
+            cache->fetches += 1;
+            dirty = hierarchyRead(hierarchy, k + 1, address);
+        }
+        hierarchyInstall(hierarchy, k, address, dirty || cache->policy->writeBack);
+        if(cache->policy->writeBack)
+            return;
+    }
+
+    // Write Through, or Around a Non-Allocating Level
+    cache->memrefs += 1;
+    hierarchyWrite(hierarchy, k + 1, address, writeback);
+}
+
+void hierarchyAccess(Hierarchy* hierarchy, Line* l)
+{
+    if(l->operation == 'R')
+        hierarchyRead(hierarchy, 0, l->address);
+    else if(l->operation == 'W')
+        hierarchyWrite(hierarchy, 0, l->address, 0);
+    else
+    {
+        // Other Operations Only Probe the First Level
+        Cache* cache = hierarchy->levels[0].cache;
+        cache->cacheReferences += 1;
+        if(findWay(cache, getIndexBits(&cache->geometry, l->address), getTagBits(&cache->geometry, l->address)) > -1)
+            cache->hits += 1;
+        else
+            cache->misses += 1;
+    }
+}
+
+void simulateHierarchy(TraceReader* reader, Hierarchy* hierarchy)
+{
+    Line lines[TRACE_BATCH_SIZE];
+    unsigned int size;
+    while((size = readTraceBatch(reader, lines, TRACE_BATCH_SIZE)) > 0)
+    {
+        unsigned int i;
+        for(i = 0; i < size; i++)
+        {
+            hierarchyAccess(hierarchy, &lines[i]);
+        }
+    }
+}
+
+void printHierarchyReport(Hierarchy* hierarchy)
+{
+    char* div = "****************************************\n";
+    int k;
+    for(k = 0; k < hierarchy->count; k++)
+    {
+        Level* level = &hierarchy->levels[k];
+        Cache* cache = level->cache;
+        printf("%s", div);
+        printf("L%d: %u sets, %u-way, %u byte blocks, %s\n", k + 1, cache->geometry.numSets, cache->geometry.associativity,
+               cache->geometry.blockSize, level->inclusion == 'i' ? "Inclusive" : level->inclusion == 'e' ? "Exclusive" : "Non-Inclusive");
+        printf("%s\n", cache->policy->name);
+        printf("%s", div);
+
+        printf("Total number of references: %lu\n", cache->cacheReferences);
+        printf("Hits: %lu\n", cache->hits);
+        printf("Misses: %lu\n", cache->misses);
+        printf("Writebacks: %lu\n", level->writebacks);
+        printf("Back-invalidations: %lu\n", level->invalidations);
+        printf("Requests to %s: %lu\n", k + 1 < hierarchy->count ? "next level" : "memory", cache->memrefs);
+    }
+
+    printf("%s", div);
+    printf("Memory\n");
+    printf("%s", div);
+    printf("Reads: %lu\n", hierarchy->memoryReads);
+    printf("Writes: %lu\n", hierarchy->memoryWrites);
+}
+
+void printHeader(const Geometry* geometry)
+{
+    printf("Block size: %d\nNumber of sets: %d\nAssociativity: %d\n", geometry->blockSize, geometry->numSets, geometry->associativity);
+    printf("Number of offset bits: %d\nNumber of index bits: %d\nNumber of tag bits: %d\n", geometry->offsetBits, geometry->indexBits, geometry->tagBits);
+}
+
+void printCacheReport(Cache* cache)
+{
+    char* div = "****************************************\n";
+    printf("%s",div);
+    printf("%s\n", cache->policy->name);
+    printf("%s",div);
+
+    printf("Total number of references: %lu\n", cache->cacheReferences);
+    printf("Hits: %lu\n", cache->hits);
+    printf("Misses: %lu\n", cache->misses);
+    printf("Memory References: %lu\n", cache->memrefs);
+    if(cache->prefetcher)
+    {
+        unsigned long covered = cache->usefulPrefetches + cache->misses;
+        printf("%s Prefetches: %lu\n", cache->prefetcher->title, cache->prefetches);
+        printf("Useful Prefetches: %lu\n", cache->usefulPrefetches);
+        printf("Accuracy: %.6f\n", cache->prefetches ? (double)cache->usefulPrefetches / cache->prefetches : 0.0);
+        printf("Coverage: %.6f\n", covered ? (double)cache->usefulPrefetches / covered : 0.0);
+        printf("Pollution: %lu\n", cache->pollution);
+    }
+    if(cache->victims)
+    {
+        const char* kind = (cache->victims->kind == 'v') ? "Victim" : "Miss";
+        printf("%s Cache Entries: %u\n", kind, cache->victims->entries);
+        printf("%s Cache Hits: %lu\n", kind, cache->victims->hits);
+        printf("Memory References Saved: %lu\n", cache->victims->hits);
+    }
+    if(cache->dram)
+    {
+        const Dram* dram = cache->dram;
+        printf("DRAM Requests: %lu\n", dram->requests);
+        printf("DRAM Writes: %lu\n", dram->writes);
+        printf("Row Hits: %lu\n", dram->rowHits);
+        printf("Row Misses: %lu\n", dram->rowMisses);
+        printf("Bank Conflicts: %lu\n", dram->conflicts);
+        printf("Row Hit Rate: %.6f\n", dram->requests ? (double)dram->rowHits / dram->requests : 0.0);
+        printf("Average Memory Latency: %.6f\n", dram->requests ? (double)dram->latency / dram->requests : 0.0);
+        printf("Queue Full Stall Cycles: %lu\n", dram->stalls);
+    }
+    if(cache->classifier)
+    {
+        unsigned long totals[3] = {0, 0, 0};
+        unsigned int i;
+        for(i = 0; i < cache->geometry.numSets * 3; i++)
+            totals[i % 3] += cache->classifier->counts[i];
+        printf("Compulsory Misses: %lu\n", totals[0]);
+        printf("Capacity Misses: %lu\n", totals[1]);
+        printf("Conflict Misses: %lu\n", totals[2]);
+
+        printf("Set,Misses,Compulsory,Capacity,Conflict\n");
+        for(i = 0; i < cache->geometry.numSets; i++)
+        {
+            const unsigned long* counts = &cache->classifier->counts[(size_t)i * 3];
+            printf("%u,%lu,%lu,%lu,%lu\n", i, counts[0] + counts[1] + counts[2], counts[0], counts[1], counts[2]);
+        }
+    }
+}
+
+/**
+ * @brief Print the timing of a run, stretching it to the memory bus's transfer time when the bus is the bottleneck.
+ * @param unsigned long references Processor references.
+ * @param double hitCycles Cycles the references spend hitting the first cache.
+ * @param double cycles Total cycles before the bus limit.
+ * @param unsigned long bytes Bytes moved between the last cache and memory.
+ * @param double bandwidth Memory bus bytes per cycle (0 leaves the bus unlimited).
+ * @return void
+ */
+static void printTiming(unsigned long references, double hitCycles, double cycles, unsigned long bytes, double bandwidth)
+{
+    double busStalls = 0.0;
+    if(bandwidth > 0.0 && bytes / bandwidth > cycles)
+    {
+        busStalls = bytes / bandwidth - cycles;
+        cycles += busStalls;
+    }
 
-/*----------------------------------*
- *             Globals               *
- *----------------------------------*/
-LineList * LINE_LIST;
-Cache* CACHE;
-unsigned int BLOCK_SIZE;
-unsigned int NUM_SETS;
-unsigned int SET_ASSOCIATIVITY;
-unsigned int OFFSET_BITS;
-unsigned int INDEX_BITS;
-unsigned int TAG_BITS;
+    printf("Average Memory Access Time: %.3f cycles\n", references ? cycles / references : 0.0);
+    printf("Total Cycles: %.0f\n", cycles);
+    printf("Stall Cycles: %.0f\n", cycles - hitCycles);
+    printf("Bytes Moved: %lu\n", bytes);
+    if(bandwidth > 0.0)
+        printf("Bandwidth Stall Cycles: %.0f\n", busStalls);
+}
 
-/*----------------------------------*
- *          IMPLEMENTATIONS         *
- *----------------------------------*/
-void initLines(void)
+void printTimingReport(const Cache* cache, const Timing* timing, double bandwidth)
 {
-    LINE_LIST = (LineList*) malloc(sizeof(LineList));
-    LINE_LIST->lines = (Line*) malloc(sizeof(Line));
-    LINE_LIST->size = 0;
+    // Memory References That are Neither Fetches Nor Writebacks Write a Single Word Through
+    unsigned long written = cache->memrefs - cache->fetches - cache->writebacks;
+    unsigned long demand = cache->fetches - cache->prefetches;
+    double hitCycles = cache->cacheReferences * timing->hitLatency;
+    double cycles = hitCycles + demand * timing->missPenalty + (cache->writebacks + written) * timing->writebackCost;
+    unsigned long bytes = (cache->fetches + cache->writebacks) * cache->geometry.blockSize + written * WORD_BYTES;
+    printTiming(cache->cacheReferences, hitCycles, cycles, bytes, bandwidth);
 }
 
-void deinitLines(void)
+void printHierarchyTiming(const Hierarchy* hierarchy, const Timing* timings, double bandwidth)
 {
-    free(LINE_LIST->lines);
-    free(LINE_LIST);
+    char* div = "****************************************\n";
+    printf("%s", div);
+    printf("Timing\n");
+    printf("%s", div);
+
+    double cycles = 0.0;
+    int k;
+    for(k = 0; k < hierarchy->count; k++)
+    {
+        const Level* level = &hierarchy->levels[k];
+        const Cache* cache = level->cache;
+        double levelCycles = cache->cacheReferences * timings[k].hitLatency + cache->fetches * timings[k].missPenalty +
+                             level->writebacks * timings[k].writebackCost;
+        printf("L%d Cycles: %.0f\n", k + 1, levelCycles);
+        cycles += levelCycles;
+    }
+
+    // Whole Blocks Reach Memory as the Last Level's Fetches and Writebacks, Anything Else Written Through is a Word
+    const Level* last = &hierarchy->levels[hierarchy->count - 1];
+    unsigned int blockSize = last->cache->geometry.blockSize;
+    unsigned long written = hierarchy->memoryWrites - last->writebacks;
+    unsigned long bytes = (hierarchy->memoryReads + last->writebacks) * blockSize + written * WORD_BYTES;
+    const Cache* first = hierarchy->levels[0].cache;
+    printTiming(first->cacheReferences, first->cacheReferences * timings[0].hitLatency, cycles, bytes, bandwidth);
 }
 
-void addLine(char operation, int address)
+void printCache(Cache* cache)
 {
-    LINE_LIST->size += 1;
-    LINE_LIST->lines = (Line*)realloc(LINE_LIST->lines, sizeof(Line)*LINE_LIST->size);
-    LINE_LIST->lines[LINE_LIST->size-1].address = address;
-    LINE_LIST->lines[LINE_LIST->size-1].operation = operation;
+    unsigned int i;
+    for(i = 0; i < cache->geometry.numSets; i++)
+    {
+        printf("Set %u: ", i);
+        size_t base = (size_t)i * cache->geometry.associativity;
+        unsigned int j;
+        for(j = 0; j < cache->geometry.associativity; j++)
+        {
+            if(testWay(&cache->valid[(size_t)i * cache->maskWords], j))
+                printf("%llu%s ", (unsigned long long)loadTag(cache, cache->tags, base + j), testWay(&cache->dirty[(size_t)i * cache->maskWords], j) ? "*" : "");
+            else
+                printf("- ");
+        }
+        printf("\n");
+    }
 }
 
-void printLines(void)
+void printTranslatedLines(void)
 {
-    int i;
+    unsigned int i;
     for(i = 0; i < LINE_LIST->size; i++)
     {
-        printf("%c %d\n", LINE_LIST->lines[i].operation, LINE_LIST->lines[i].address);
+        printf("%c %llu %llu %u %u\n", LINE_LIST->lines[i].operation, (unsigned long long)LINE_LIST->lines[i].address, (unsigned long long)getTagBits(&GEOMETRY, LINE_LIST->lines[i].address), getIndexBits(&GEOMETRY, LINE_LIST->lines[i].address), getOffsetBits(&GEOMETRY, LINE_LIST->lines[i].address));
     }
 }
 
-void parseInput(void)
+void printInput(void)
 {
-    // Get Base Variables
-    scanf("%d", &BLOCK_SIZE);
-    scanf("%d", &NUM_SETS);
-    scanf("%d\n", &SET_ASSOCIATIVITY);
-
-    // Indefinite Line Input
-    char lineBuffer[256];
-    char op;
-    int add;
-    while(fgets(lineBuffer, 256, stdin))
-    {
-        sscanf(lineBuffer,"%c %d", &op, &add);
-        addLine(op,add);
-    }
+    printf("Block Size: %d\nNumber of Sets: %d\nSet Associativity: %d\nLines: %d\n", GEOMETRY.blockSize, GEOMETRY.numSets, GEOMETRY.associativity, LINE_LIST->size);
+    printLines();
 }
 
-void initCache(void)
+int parseArguments(int argc, char** argv)
 {
-    CACHE = (Cache*)malloc(sizeof(Cache));
-    CACHE->sets = (Set*)calloc(NUM_SETS,sizeof(Set));
     int i;
-    for(i = 0; i < NUM_SETS; i++)
+    for(i = 1; i < argc; i++)
     {
-        CACHE->sets[i].blocks = (Block*)calloc(SET_ASSOCIATIVITY,sizeof(Block));
-        
-        int j;
-        for(j = 0; j < SET_ASSOCIATIVITY; j++)
+        if(strcmp(argv[i], "-c") == 0 && i + 1 < argc)
+            OPTIONS.convertPath = argv[++i];
+        else if(strcmp(argv[i], "-A") == 0 && i + 1 < argc)
+        {
+            if(sscanf(argv[++i], "%u", &OPTIONS.addressBits) != 1 || OPTIONS.addressBits == 0 || OPTIONS.addressBits > 64)
+                return 0;
+        }
+        else if(strcmp(argv[i], "-w") == 0 && i + 1 < argc)
+            OPTIONS.policies = argv[++i];
+        else if(strcmp(argv[i], "-S") == 0 && i + 1 < argc)
+            OPTIONS.sweep = argv[++i];
+        else if(strcmp(argv[i], "-g") == 0 && i + 1 < argc)
+            OPTIONS.workload = argv[++i];
+        else if(strcmp(argv[i], "-B") == 0 && i + 1 < argc)
+            OPTIONS.benchmark = argv[++i];
+        else if(strcmp(argv[i], "-e") == 0 && i + 1 < argc)
+        {
+            // A Trailing :tolerance Overrides the Slowdown Allowed
+            OPTIONS.baselinePath = argv[++i];
+            char* colon = strrchr(argv[i], ':');
+            double tolerance;
+            int used;
+            if(colon && sscanf(colon + 1, "%lf%n", &tolerance, &used) == 1 && colon[1 + used] == '\0')
+            {
+                if(!(tolerance >= 0.0 && tolerance < 1.0))
+                    return 0;
+                OPTIONS.tolerance = tolerance;
+                *colon = '\0';
+            }
+        }
+        else if(strcmp(argv[i], "-L") == 0 && i + 1 < argc)
+        {
+            if(OPTIONS.levelCount == MAX_LEVELS)
+                return 0;
+            OPTIONS.levels[OPTIONS.levelCount++] = argv[++i];
+        }
+        else if(strcmp(argv[i], "-m") == 0 && i + 1 < argc)
+        {
+            char protocol[8];
+            if(sscanf(argv[++i], "%7[a-z]:%u", protocol, &OPTIONS.cores) != 2 || OPTIONS.cores == 0 || OPTIONS.cores > MAX_CORES)
+                return 0;
+            if(strcmp(protocol, "mesi") == 0)
+                OPTIONS.protocol = 'm';
+            else if(strcmp(protocol, "moesi") == 0)
+                OPTIONS.protocol = 'o';
+            else
+                return 0;
+        }
+        else if(strcmp(argv[i], "-D") == 0 && i + 1 < argc)
+        {
+            DramConfig* dram = &OPTIONS.dram;
+            char page[8];
+            int fields = sscanf(argv[++i], "%u:%u:%7[a-z]:%u:%u", &dram->banks, &dram->rowBytes, page, &dram->depth, &dram->gap);
+            if(fields < 3 || dram->banks == 0 || dram->rowBytes == 0 || dram->depth == 0 || dram->depth > MAX_DRAM_QUEUE_DEPTH)
+                return 0;
+            if(strcmp(page, "open") == 0)
+                dram->page = 'o';
+            else if(strcmp(page, "closed") == 0)
+                dram->page = 'c';
+            else
+                return 0;
+        }
+        else if(strcmp(argv[i], "-p") == 0 && i + 1 < argc)
+        {
+            if(!(OPTIONS.prefetcher = findPrefetcher(argv[++i])))
+                return 0;
+        }
+        else if(strcmp(argv[i], "-v") == 0 && i + 1 < argc)
+        {
+            char kind[8];
+            if(sscanf(argv[++i], "%7[a-z]:%u", kind, &OPTIONS.victimEntries) != 2 ||
+               OPTIONS.victimEntries == 0 || OPTIONS.victimEntries > MAX_VICTIM_ENTRIES)
+                return 0;
+            if(strcmp(kind, "victim") == 0)
+                OPTIONS.victimKind = 'v';
+            else if(strcmp(kind, "miss") == 0)
+                OPTIONS.victimKind = 'm';
+            else
+                return 0;
+        }
+        else if(strcmp(argv[i], "-s") == 0 && i + 1 < argc)
+        {
+            // Round the Rate Down to a Power of Two, so the Sets Divide Evenly
+            double rate;
+            int fields = sscanf(argv[++i], "%lf:%u", &rate, &OPTIONS.seeds);
+            if(fields < 1 || !(rate > 0.0 && rate <= 1.0) || OPTIONS.seeds < 2 || OPTIONS.seeds > MAX_SEEDS)
+                return 0;
+            OPTIONS.sampleShift = 0;
+            while(OPTIONS.sampleShift < 31 && 1.0 / (1u << OPTIONS.sampleShift) > rate * (1.0 + 1e-9))
+                OPTIONS.sampleShift++;
+        }
+        else if(strcmp(argv[i], "-i") == 0 && i + 1 < argc)
+        {
+            if(sscanf(argv[++i], "%lu:%lu", &OPTIONS.interval, &OPTIONS.warmup) < 1 || OPTIONS.interval == 0)
+                return 0;
+        }
+        else if(strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+        {
+            OPTIONS.intervalPath = argv[++i];
+        }
+        else if(strcmp(argv[i], "-T") == 0 && i + 1 < argc && OPTIONS.timingCount < MAX_LEVELS)
+        {
+            // The Writeback Cost Defaults to the Miss Penalty
+            Timing* timing = &OPTIONS.timings[OPTIONS.timingCount++];
+            int fields = sscanf(argv[++i], "%lf:%lf:%lf", &timing->hitLatency, &timing->missPenalty, &timing->writebackCost);
+            if(fields < 2 || timing->hitLatency < 0.0 || timing->missPenalty < 0.0 || (fields == 3 && timing->writebackCost < 0.0))
+                return 0;
+            if(fields == 2)
+                timing->writebackCost = timing->missPenalty;
+        }
+        else if(strcmp(argv[i], "-b") == 0 && i + 1 < argc)
+        {
+            if(sscanf(argv[++i], "%lf", &OPTIONS.bandwidth) != 1 || OPTIONS.bandwidth <= 0.0)
+                return 0;
+        }
+        else if(strcmp(argv[i], "-k") == 0 && i + 1 < argc)
+        {
+            OPTIONS.savePath = argv[++i];
+        }
+        else if(strcmp(argv[i], "-K") == 0 && i + 1 < argc)
+        {
+            OPTIONS.restorePath = argv[++i];
+        }
+        else if(strcmp(argv[i], "-Z") == 0)
+        {
+            OPTIONS.clearRestored = 1;
+        }
+        else if(strcmp(argv[i], "-3") == 0)
+            OPTIONS.classify = 1;
+        else if(strcmp(argv[i], "-R") == 0)
+            OPTIONS.collapseRuns = 1;
+        else if(strcmp(argv[i], "-r") == 0 && i + 1 < argc)
+        {
+            if(!(OPTIONS.replacement = findReplacementPolicy(argv[++i])))
+                return 0;
+        }
+        else if(strcmp(argv[i], "-x") == 0 && i + 1 < argc)
+        {
+            if(!(OPTIONS.indexing = findIndexFunction(argv[++i])))
+                return 0;
+        }
+        else if(strcmp(argv[i], "-f") == 0 && i + 1 < argc)
+        {
+            i++;
+            if(strcmp(argv[i], "csv") == 0)
+                OPTIONS.format = 'c';
+            else if(strcmp(argv[i], "json") == 0)
+                OPTIONS.format = 'j';
+            else
+                return 0;
+        }
+        else if(strcmp(argv[i], "-t") == 0 && i + 1 < argc)
+        {
+            if(sscanf(argv[++i], "%u", &OPTIONS.threads) != 1 || OPTIONS.threads == 0 || OPTIONS.threads > MAX_THREADS)
+                return 0;
+        }
+        else if(strcmp(argv[i], "-d") == 0 && i + 1 < argc)
         {
-            CACHE->sets[i].blocks[j].address = -1;
-            CACHE->sets[i].blocks[j].dirty = 0;
-            CACHE->sets[i].blocks[j].lastused = 0;
+            if(sscanf(argv[++i], "%u:%u", &OPTIONS.curveSets, &OPTIONS.curveWays) != 2 ||
+               OPTIONS.curveSets == 0 || (OPTIONS.curveSets & (OPTIONS.curveSets - 1)) || OPTIONS.curveWays == 0)
+                return 0;
         }
+        else if(argv[i][0] != '-' && !OPTIONS.tracePath)
+            OPTIONS.tracePath = argv[i];
+        else
+            return 0;
     }
 
-    CACHE->hits = 0;
-    CACHE->misses = 0;
-    CACHE->memrefs = 0;
-    CACHE->cacheReferences = 0;
+    // The Miss-Ratio Curve Indexes by Modulo, and Skewed Caches Replace by Their Own LRU Stamps Within a Single Cache
+    if(OPTIONS.indexing != &INDEX_FUNCTIONS[0] && OPTIONS.curveSets)
+        return 0;
+    if(OPTIONS.indexing->id == 's' && (OPTIONS.replacement != &REPLACEMENT_POLICIES[0] || OPTIONS.prefetcher ||
+       OPTIONS.levelCount || OPTIONS.protocol))
+        return 0;
+
+    // One Timing per Hierarchy Level (or for the Single Cache), and None for the Modes That Report No Time
+    if(OPTIONS.timingCount && (OPTIONS.timingCount != (OPTIONS.levelCount ? OPTIONS.levelCount : 1) || OPTIONS.protocol ||
+       OPTIONS.sampleShift || OPTIONS.sweep || OPTIONS.benchmark || OPTIONS.curveSets))
+        return 0;
+    if(OPTIONS.bandwidth > 0.0 && !OPTIONS.timingCount)
+        return 0;
+
+    // Checkpoints Hold the Single Cache Mode's Caches Only
+    if((OPTIONS.savePath || OPTIONS.restorePath) && (OPTIONS.levelCount || OPTIONS.protocol || OPTIONS.sampleShift ||
+       OPTIONS.sweep || OPTIONS.benchmark || OPTIONS.curveSets))
+        return 0;
+
+    // The DRAM Sits Behind the Single Cache Mode's Caches Only
+    if(OPTIONS.dram.banks && (OPTIONS.levelCount || OPTIONS.protocol || OPTIONS.sampleShift || OPTIONS.sweep ||
+       OPTIONS.benchmark || OPTIONS.curveSets))
+        return 0;
+
+    // Each Policy at Most Once
+    const char* p;
+    for(p = OPTIONS.policies; *p; p++)
+    {
+        if(!findWritePolicy(*p) || strchr(p + 1, *p))
+            return 0;
+    }
+    return *OPTIONS.policies != '\0';
 }
 
-void deinitCache(void)
+void printUsage(const char* program)
 {
+    fprintf(stderr, "Usage: %s [-A bits] [-c binaryTrace] [-w policies] [-r replacement] [-x index] [-p prefetcher] [-v kind:entries] [-3] [-R] [-i interval[:warmup] [-o file]] [-T hit:miss[:writeback]]... [-b bandwidth] [-D banks:rowBytes:page[:queue[:gap]]] [-K checkpoint [-Z]] [-k checkpoint] [-s rate[:seeds]] [-L level]... [-m protocol:cores] [-t threads] [-d sets:ways] [-S sweep [-f csv|json]] [-B sweep [-e baseline[:tolerance]]] [-g workload] [trace]\n", program);
+    fprintf(stderr, "  trace           Trace file to memory map, otherwise the trace is streamed from stdin\n");
+    fprintf(stderr, "  -A bits         Width of the trace's addresses, up to 64 (default 32), higher bits are dropped\n");
+    fprintf(stderr, "  -c binaryTrace  Convert the trace to the binary format instead of simulating\n");
+    fprintf(stderr, "  -d sets:ways    Print the LRU miss-ratio curve for every power of two set count up to sets\n");
+    fprintf(stderr, "                  and every associativity up to ways, from one pass\n");
+    fprintf(stderr, "  -S sweep        Simulate every blockSizes:sets:associativities combination concurrently, where each\n");
+    fprintf(stderr, "                  field lists values and power of two ranges (e.g. 16-128:64,256:1,2,8-32)\n");
+    fprintf(stderr, "  -f format       Sweep table format, csv (default) or json\n");
+    fprintf(stderr, "  -B sweep        Time every configuration of a sweep on one thread, reporting references per second\n");
+    fprintf(stderr, "  -e baseline[:tolerance]  Compare the benchmark against an earlier one's CSV, failing if any\n");
+    fprintf(stderr, "                  configuration is more than tolerance slower (default 0.1)\n");
+    fprintf(stderr, "  -g workload     Write a synthetic trace, kind[=param]:references[:footprint[:writes[:seed]]], where\n");
+    fprintf(stderr, "                  kind is seq, stride[=bytes], random, zipf[=alpha], chase, or mix (default footprint\n");
+    fprintf(stderr, "                  1M, writes 0.3, seed 1, stride 256, alpha 0.99)\n");
+    fprintf(stderr, "  -L level        Add a hierarchy level, nearest the processor first, as blockSize:sets:ways:policy[:i|e|n]\n");
+    fprintf(stderr, "                  (inclusive, exclusive or non-inclusive of the levels above, default n)\n");
+    fprintf(stderr, "  -m protocol:cores  Simulate cores with private write-back caches of the trace's geometry, kept\n");
+    fprintf(stderr, "                  coherent by mesi or moesi, where trace lines may start with a core ID\n");
+    fprintf(stderr, "  -p prefetcher   Prefetch into the cache with next (line), stride, or delta (correlation)\n");
+    fprintf(stderr, "  -v kind:entries Attach a fully associative victim or miss cache of up to 64 blocks, probed on misses\n");
+    fprintf(stderr, "  -3              Classify misses as compulsory, capacity, or conflict, overall and per set\n");
+    fprintf(stderr, "  -R              Run length encode references to one block while reading, simulating each run at once\n");
+    fprintf(stderr, "  -i interval[:warmup]  Write each cache's counters every interval references as CSV, leaving the\n");
+    fprintf(stderr, "                  first warmup intervals out of the report\n");
+    fprintf(stderr, "  -o file         Write the interval CSV to file instead of stdout\n");
+    fprintf(stderr, "  -T hit:miss[:writeback]  Estimate time from the cycles of a hit, a miss fetch, and a writeback\n");
+    fprintf(stderr, "                  (default the miss penalty), repeated per hierarchy level nearest the processor first\n");
+    fprintf(stderr, "  -b bandwidth    Limit the memory bus to bandwidth bytes per cycle in the timing estimate\n");
+    fprintf(stderr, "  -D banks:rowBytes:page[:queue[:gap]]  Send the memory references to banked DRAM with open or closed\n");
+    fprintf(stderr, "                  page row buffers, scheduled FR-FCFS from a queue of requests (default 32) arriving\n");
+    fprintf(stderr, "                  gap cycles per reference apart (default 4), reporting row hits and latency\n");
+    fprintf(stderr, "  -K checkpoint   Restore the caches (contents and counters) from a checkpoint before simulating\n");
+    fprintf(stderr, "  -Z              Zero the restored counters, so the report covers only this trace\n");
+    fprintf(stderr, "  -k checkpoint   Save the caches to a checkpoint after simulating\n");
+    fprintf(stderr, "  -s rate[:seeds] Estimate from independent spatial samples (default 4) of about rate of the blocks,\n");
+    fprintf(stderr, "                  on caches (or miss-ratio curve set counts) scaled down to match\n");
+    fprintf(stderr, "  -r replacement  Replacement policy (default lru):");
     int i;
-    for(i = 0; i < NUM_SETS; i++)
+    for(i = 0; i < MAX_REPLACEMENT_POLICIES; i++)
+        fprintf(stderr, " %s", REPLACEMENT_POLICIES[i].name);
+    fprintf(stderr, "\n");
+    fprintf(stderr, "  -x index        Set index function (default mod): mod, xor (tag folded into the index), prime\n");
+    fprintf(stderr, "                  (modulo the largest prime up to the set count), or skew (a hash per way, lru only)\n");
+    fprintf(stderr, "  -t threads      Simulate on worker threads, each owning a range of sets (or sweep configurations)\n");
+    fprintf(stderr, "  -w policies     Write policies to simulate in one pass (default TB):\n");
+    for(i = 0; i < MAX_POLICIES; i++)
+        fprintf(stderr, "                    %c  %s\n", WRITE_POLICIES[i].id, WRITE_POLICIES[i].name);
+}
+
+double logBase(int num, int base)
+{
+    return (log(num)/log(base));
+}
+
+/*----------------------------------*
+ *            LIBRARY API           *
+ *----------------------------------*/
+CacheSim* cachesimCreate(const CacheSimConfig* config)
+{
+    // Validate the Configuration as the Hierarchy Levels Are
+    Geometry geometry = {0};
+    geometry.blockSize = config->blockSize;
+    geometry.numSets = config->numSets;
+    geometry.associativity = config->associativity;
+    geometry.addressBits = config->addressBits ? config->addressBits : 32;
+    const WritePolicy* policy = findWritePolicy(config->writePolicy ? config->writePolicy : 'B');
+    const ReplacementPolicy* replacement = config->replacement ? findReplacementPolicy(config->replacement) : &REPLACEMENT_POLICIES[0];
+    const Prefetcher* prefetcher = config->prefetcher ? findPrefetcher(config->prefetcher) : NULL;
+    const IndexFunction* indexing = config->indexing ? findIndexFunction(config->indexing) : &INDEX_FUNCTIONS[0];
+    if(!policy || !replacement || (config->prefetcher && !prefetcher) || !indexing)
+        return NULL;
+    if(indexing->id == 's' && (replacement != &REPLACEMENT_POLICIES[0] || prefetcher))
+        return NULL;
+    geometry.indexing = indexing->id;
+    if(!geometry.blockSize || (geometry.blockSize & (geometry.blockSize - 1)) ||
+       !geometry.numSets || (geometry.numSets & (geometry.numSets - 1)) || !geometry.associativity ||
+       !supportsReplacement(&geometry, replacement))
+        return NULL;
+    if(config->victimKind && ((config->victimKind != 'v' && config->victimKind != 'm') ||
+       config->victimEntries < 1 || config->victimEntries > MAX_VICTIM_ENTRIES))
+        return NULL;
+
+    if(geometry.addressBits > 64 || !calculateAddressBits(&geometry))
+        return NULL;
+
+    CacheSim* sim = (CacheSim*)malloc(sizeof(CacheSim));
+    sim->cache = initCache(&geometry, policy, replacement);
+    sim->addressMask = getAddressMask(geometry.addressBits);
+    if(prefetcher)
+        setPrefetcher(sim->cache, prefetcher);
+    if(config->victimKind)
+        setVictimCache(sim->cache, config->victimKind, config->victimEntries);
+    if(config->classify)
+        setClassifier(sim->cache);
+    return sim;
+}
+
+void cachesimDestroy(CacheSim* sim)
+{
+    deinitCache(sim->cache);
+    free(sim);
+}
+
+int cachesimAccess(CacheSim* sim, uint64_t address, char operation)
+{
+    Line l = {operation, 0, address & sim->addressMask};
+    unsigned long hits = sim->cache->hits;
+    cacheLine(sim->cache, &l);
+    return sim->cache->hits != hits;
+}
+
+void cachesimAccessMany(CacheSim* sim, const uint64_t* addresses, const char* operations, size_t count)
+{
+    size_t i;
+    for(i = 0; i < count; i++)
     {
-        free(CACHE->sets[i].blocks);
+        Line l = {operations ? operations[i] : 'R', 0, addresses[i] & sim->addressMask};
+        cacheLine(sim->cache, &l);
     }
-    free(CACHE->sets);
-    free(CACHE);
 }
 
-void resetCache(void)
+void cachesimStats(const CacheSim* sim, CacheSimStats* stats)
 {
-    int i;
-    for(i = 0; i < NUM_SETS; i++)
+    const Cache* cache = sim->cache;
+    memset(stats, 0, sizeof(CacheSimStats));
+    stats->references = cache->cacheReferences;
+    stats->hits = cache->hits;
+    stats->misses = cache->misses;
+    stats->memoryReferences = cache->memrefs;
+    stats->fetches = cache->fetches;
+    stats->writebacks = cache->writebacks;
+    stats->prefetches = cache->prefetches;
+    stats->usefulPrefetches = cache->usefulPrefetches;
+    if(cache->victims)
+        stats->victimHits = cache->victims->hits;
+    if(cache->classifier)
     {
-        int j;
-        for(j = 0; j < SET_ASSOCIATIVITY; j++)
+        unsigned int i;
+        for(i = 0; i < cache->geometry.numSets; i++)
         {
-            CACHE->sets[i].blocks[j].address = -1;
-            CACHE->sets[i].blocks[j].dirty = 0;
-            CACHE->sets[i].blocks[j].lastused = 0;
+            stats->compulsory += cache->classifier->counts[(size_t)i * 3];
+            stats->capacity += cache->classifier->counts[(size_t)i * 3 + 1];
+            stats->conflict += cache->classifier->counts[(size_t)i * 3 + 2];
         }
     }
-
-    CACHE->hits = 0;
-    CACHE->misses = 0;
-    CACHE->memrefs = 0;
-    CACHE->cacheReferences = 0;
 }
 
-void calculateAddressBits(void)
+void cachesimReset(CacheSim* sim)
 {
-    OFFSET_BITS = logBase(BLOCK_SIZE,2);
-    INDEX_BITS = logBase(NUM_SETS,2);
-    TAG_BITS = 32 - OFFSET_BITS - INDEX_BITS;
+    resetCache(sim->cache);
 }
 
-unsigned int getTagBits(unsigned int address)
+int cachesimSave(CacheSim* sim, const char* path)
 {
-    return address >> (OFFSET_BITS+INDEX_BITS);
+    return saveCheckpoint(&sim->cache, 1, path);
 }
 
-unsigned int getIndexBits(unsigned int address)
+int cachesimRestore(CacheSim* sim, const char* path)
 {
-    address = address << TAG_BITS;
-    return address >> (TAG_BITS + OFFSET_BITS);
+    return restoreCheckpoint(&sim->cache, 1, path);
 }
 
-unsigned int getOffsetBits(unsigned int address)
+/*----------------------------------*
+ *                MAIN              *
+ *----------------------------------*/
+#if !defined(CACHESIM_LIBRARY)
+int main(int argc, char** argv)
 {
-    address = address << (TAG_BITS+INDEX_BITS);
-    return address >> (TAG_BITS+INDEX_BITS);
-}
+    // Parse Command Line
+    if(!parseArguments(argc, argv))
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
 
-int lruReplace(Line* l, int lineNum)
-{
-    int setTarget = 0;
-    int replacementSet = 0;
-    int lru = CACHE->sets[getIndexBits(l->address)].blocks[0].lastused;
-    while(setTarget < SET_ASSOCIATIVITY)
+    // Generate a Synthetic Trace Instead of Reading One
+    if(OPTIONS.workload)
     {
-        if(CACHE->sets[getIndexBits(l->address)].blocks[setTarget].lastused < lru)
+        Workload workload;
+        if(!parseWorkload(OPTIONS.workload, &workload))
         {
-            lru = CACHE->sets[getIndexBits(l->address)].blocks[setTarget].lastused;
-            replacementSet = setTarget;
+            fprintf(stderr, "Malformed workload %s\n", OPTIONS.workload);
+            return 1;
         }
-        setTarget += 1;
+        return generateWorkload(&workload, stdout) ? 0 : 1;
     }
-    CACHE->sets[getIndexBits(l->address)].blocks[replacementSet].lastused = lineNum;
-    CACHE->sets[getIndexBits(l->address)].blocks[replacementSet].address = l->address;
-    if(CACHE->sets[getIndexBits(l->address)].blocks[replacementSet].dirty)
+
+    // Open Trace (Memory Mapped File Argument, Otherwise Streamed stdin)
+    TraceReader* reader = openTraceReader(OPTIONS.tracePath);
+    if(!reader)
+        return 1;
+
+    // Parse Trace Header
+    if(!readTraceHeader(reader))
     {
-        CACHE->memrefs += 1;
+        fprintf(stderr, "Malformed trace header\n");
+        closeTraceReader(reader);
+        return 1;
     }
-    CACHE->sets[getIndexBits(l->address)].blocks[replacementSet].dirty = 0;
-    return replacementSet;
-}
 
-void cacheLine(Line* l, int lineNum, char cachingMethod)
-{
-    CACHE->cacheReferences += 1;
-    int hit = -1;
-    int freeSpace = -1;
+    // Convert to the Binary Trace Format Instead of Simulating
+    if(OPTIONS.convertPath)
+    {
+        int converted = convertTrace(reader, OPTIONS.convertPath);
+        closeTraceReader(reader);
+        return converted ? 0 : 1;
+    }
 
-    unsigned int setTarget = 0;
-    // Check for Existing Identical Tag to Update
-    while(setTarget < SET_ASSOCIATIVITY)
+    // Sweep Configurations Over the Trace, Loaded Once and Shared by the Workers
+    if(OPTIONS.sweep)
     {
-        if(getTagBits(CACHE->sets[getIndexBits(l->address)].blocks[setTarget].address) == getTagBits(l->address))
+        unsigned int count;
+        SweepJob* jobs = parseSweep(OPTIONS.sweep, &count);
+        if(!jobs)
         {
-            hit = setTarget;
-            CACHE->hits += 1;
-            break;
+            fprintf(stderr, "Malformed sweep %s\n", OPTIONS.sweep);
+            closeTraceReader(reader);
+            return 1;
         }
-        setTarget += 1;
-    }
 
-    // No Existing Identical Tag, Seek Empty Block
-    if(hit<0)
-    {
-        CACHE->misses += 1;
-        setTarget = 0;
-        while(setTarget < SET_ASSOCIATIVITY)
+        unsigned int j;
+        for(j = 0; j < count; j++)
         {
-            if(CACHE->sets[getIndexBits(l->address)].blocks[setTarget].address < 0)
+            if(!supportsReplacement(&jobs[j].geometry, OPTIONS.replacement))
             {
-                freeSpace = setTarget;
-                break;
+                fprintf(stderr, "%s replacement requires a power of two associativity\n", OPTIONS.replacement->title);
+                free(jobs);
+                closeTraceReader(reader);
+                return 1;
             }
-            // Iterate to find a blank point in the cache
-            setTarget += 1;
         }
+
+        initLines();
+        loadLines(reader);
+        closeTraceReader(reader);
+
+        runSweep(jobs, count, OPTIONS.threads);
+        printSweep(jobs, count, OPTIONS.format);
+
+        free(jobs);
+        deinitLines();
+        return 0;
     }
 
-    // ---------- Process ----------
-    if(cachingMethod == 'T')
+    // Time Configurations Over the Loaded Trace, Flagging Any Slower Than the Baseline
+    if(OPTIONS.benchmark)
     {
-        // Write Through Rules
-        if(l->operation == 'R')
+        unsigned int count, baselineCount = 0;
+        SweepJob* jobs = parseSweep(OPTIONS.benchmark, &count);
+        if(!jobs)
         {
-            if(hit > -1)
-            {
-                // Read Hit
-                CACHE->sets[getIndexBits(l->address)].blocks[hit].lastused = lineNum;
-            }
-            else
-            {
-                // Read Miss
-                CACHE->memrefs += 1;
-
-                if(freeSpace > -1)
-                {
-                    CACHE->sets[getIndexBits(l->address)].blocks[freeSpace].lastused = lineNum;
-                    CACHE->sets[getIndexBits(l->address)].blocks[freeSpace].address = l->address;
-                }
-                else
-                {
-                    // LRU Replacement
-                    lruReplace(l,lineNum);
-                }
-            }
+            fprintf(stderr, "Malformed benchmark %s\n", OPTIONS.benchmark);
+            closeTraceReader(reader);
+            return 1;
         }
-        else if(l->operation == 'W')
+
+        unsigned int j;
+        for(j = 0; j < count; j++)
         {
-            if(hit > -1)
+            if(!supportsReplacement(&jobs[j].geometry, OPTIONS.replacement))
             {
-                // Write Hit
-                CACHE->memrefs += 1;
-                CACHE->sets[getIndexBits(l->address)].blocks[hit].address = l->address;
-                CACHE->sets[getIndexBits(l->address)].blocks[hit].lastused = lineNum;
-            }
-            else
-            {
-                // Write Miss
-                CACHE->memrefs += 1;
+                fprintf(stderr, "%s replacement requires a power of two associativity\n", OPTIONS.replacement->title);
+                free(jobs);
+                closeTraceReader(reader);
+                return 1;
             }
         }
-    }
-    else if(cachingMethod == 'B')
-    {
-        // Write Back Rules
-        if(l->operation == 'R')
+
+        Baseline* baseline = NULL;
+        if(OPTIONS.baselinePath && !(baseline = loadBaseline(OPTIONS.baselinePath, &baselineCount)))
         {
-            if(hit > -1)
-            {
-                // Read Hit
-                CACHE->sets[getIndexBits(l->address)].blocks[hit].lastused = lineNum;
-            }
-            else
-            {
-                // Read Miss
-                CACHE->memrefs += 1;
-                if(freeSpace > -1)
-                {
-                    CACHE->sets[getIndexBits(l->address)].blocks[freeSpace].lastused = lineNum;
-                    CACHE->sets[getIndexBits(l->address)].blocks[freeSpace].address = l->address;
-                }
-                else
-                {
-                    // LRU Replacement
-                    lruReplace(l, lineNum);
-                }
-            }
+            fprintf(stderr, "Unable to read baseline %s\n", OPTIONS.baselinePath);
+            free(jobs);
+            closeTraceReader(reader);
+            return 1;
         }
-        else if(l->operation == 'W')
+
+        initLines();
+        loadLines(reader);
+        closeTraceReader(reader);
+
+        runBenchmark(jobs, count, BENCH_REPEATS);
+        unsigned int regressions = printBenchmark(jobs, count, baseline, baselineCount, OPTIONS.tolerance);
+        if(regressions)
+            fprintf(stderr, "%u configurations more than %.0f%% slower than the baseline\n", regressions, OPTIONS.tolerance * 100.0);
+
+        free(baseline);
+        free(jobs);
+        deinitLines();
+        return regressions ? 1 : 0;
+    }
+
+    // Run the Trace Through a Hierarchy of Levels Instead of the Trace's Geometry
+    if(OPTIONS.levelCount)
+    {
+        Hierarchy* hierarchy = initHierarchy(OPTIONS.levels, OPTIONS.levelCount);
+        if(!hierarchy)
         {
-            if(hit > -1)
-            {
-                // Write Hit
-                CACHE->sets[getIndexBits(l->address)].blocks[hit].lastused = lineNum;
-                CACHE->sets[getIndexBits(l->address)].blocks[hit].address = l->address;
-                CACHE->sets[getIndexBits(l->address)].blocks[hit].dirty = 1;
-            }
-            else
-            {
-                // Write Miss
-                CACHE->memrefs += 1;
-                if(freeSpace > -1)
-                {
-                    CACHE->sets[getIndexBits(l->address)].blocks[freeSpace].lastused = lineNum;
-                    CACHE->sets[getIndexBits(l->address)].blocks[freeSpace].address = l->address;
-                    CACHE->sets[getIndexBits(l->address)].blocks[freeSpace].dirty = 1;
-                }
-                else
-                {
-                    // LRU Replacement
-                    int replacementSet = lruReplace(l, lineNum);
-                    CACHE->sets[getIndexBits(l->address)].blocks[replacementSet].dirty = 1;
-                }
-            }
+            fprintf(stderr, "Malformed hierarchy level\n");
+            closeTraceReader(reader);
+            return 1;
         }
+
+        if(OPTIONS.replacement != &REPLACEMENT_POLICIES[0])
+            printf("Replacement policy: %s\n", OPTIONS.replacement->title);
+        if(OPTIONS.indexing != &INDEX_FUNCTIONS[0])
+            printf("Index function: %s\n", OPTIONS.indexing->title);
+        simulateHierarchy(reader, hierarchy);
+        printHierarchyReport(hierarchy);
+        if(OPTIONS.timingCount)
+            printHierarchyTiming(hierarchy, OPTIONS.timings, OPTIONS.bandwidth);
+
+        closeTraceReader(reader);
+        deinitHierarchy(hierarchy);
+        return 0;
     }
-}
 
-void simulate(char cachingMethod)
-{
-    int i;
-    for(i = 0; i < LINE_LIST->size; i++)
+    // Calculate & Print Common/Shared Cache Information
+    GEOMETRY.addressBits = OPTIONS.addressBits;
+    GEOMETRY.indexing = OPTIONS.indexing->id;
+    if(!calculateAddressBits(&GEOMETRY))
+    {
+        fprintf(stderr, "%u address bits cannot hold the %u offset and index bits\n", GEOMETRY.addressBits, GEOMETRY.offsetBits + GEOMETRY.indexBits);
+        closeTraceReader(reader);
+        return 1;
+    }
+    if(!OPTIONS.curveSets && !supportsReplacement(&GEOMETRY, OPTIONS.replacement))
+    {
+        fprintf(stderr, "%s replacement requires a power of two associativity\n", OPTIONS.replacement->title);
+        closeTraceReader(reader);
+        return 1;
+    }
+    printHeader(&GEOMETRY);
+    if(!OPTIONS.curveSets && OPTIONS.replacement != &REPLACEMENT_POLICIES[0])
+        printf("Replacement policy: %s\n", OPTIONS.replacement->title);
+    if(OPTIONS.indexing != &INDEX_FUNCTIONS[0])
+        printf("Index function: %s over %u sets\n", OPTIONS.indexing->title, GEOMETRY.modulus);
+
+    // Simulate Coherent Private Caches, One per Core
+    if(OPTIONS.protocol)
     {
-        if(cachingMethod == 'T')
+        System* system = initSystem(&GEOMETRY, OPTIONS.cores, OPTIONS.protocol);
+        simulateSystem(reader, system, OPTIONS.threads);
+        printSystemReport(system);
+
+        closeTraceReader(reader);
+        deinitSystem(system);
+        return 0;
+    }
+
+    // Build the Miss-Ratio Curve From Samples, Scaling Each Set Count Down by the Sampling Rate
+    if(OPTIONS.curveSets && OPTIONS.sampleShift)
+    {
+        StackDistance* engines[32 * MAX_SEEDS];
+        int count = 0;
+        unsigned int sets;
+        for(sets = 1u << OPTIONS.sampleShift; sets && sets <= OPTIONS.curveSets; sets *= 2)
         {
-            cacheLine(&LINE_LIST->lines[i], i+1, cachingMethod);
+            unsigned int seed;
+            for(seed = 0; seed < OPTIONS.seeds; seed++)
+            {
+                StackDistance* engine = initStackDistance(count, OPTIONS.curveWays);
+                engine->seed = seed + 1;
+                engine->sampleShift = OPTIONS.sampleShift;
+                engines[count * OPTIONS.seeds + seed] = engine;
+            }
+            count++;
         }
-        else if(cachingMethod == 'B')
+        if(!count)
         {
-            cacheLine(&LINE_LIST->lines[i], i+1, cachingMethod);
+            fprintf(stderr, "Sampling rate is below 1/%u, the largest set count\n", OPTIONS.curveSets);
+            closeTraceReader(reader);
+            return 1;
         }
-    }
-}
 
-void printHeader(void)
-{
-    printf("Block size: %d\nNumber of sets: %d\nAssociativity: %d\n", BLOCK_SIZE, NUM_SETS, SET_ASSOCIATIVITY);
-    printf("Number of offset bits: %d\nNumber of index bits: %d\nNumber of tag bits: %d\n", OFFSET_BITS, INDEX_BITS, TAG_BITS);
-}
-
-void printCacheReport(char cachingMethod)
-{
-    char* div = "****************************************\n";
-    printf("%s",div);
-    if(cachingMethod == 'T')
-        printf("Write-through with No Write Allocate\n");
-    else if(cachingMethod == 'B')
-        printf("Write-back with Write Allocate\n");
-    printf("%s",div);
+        unsigned long references = simulateStackDistance(reader, engines, count * OPTIONS.seeds);
+        printSampledMissRatioCurve(engines, count, OPTIONS.seeds, references);
 
-    printf("Total number of references: %d\n", CACHE->cacheReferences);
-    printf("Hits: %d\n", CACHE->hits);
-    printf("Misses: %d\n", CACHE->misses);
-    printf("Memory References: %d\n", CACHE->memrefs);
-}
+        closeTraceReader(reader);
+        int i;
+        for(i = 0; i < count * (int)OPTIONS.seeds; i++)
+            deinitStackDistance(engines[i]);
+        return 0;
+    }
 
-void printCache(void)
-{
-    int i;
-    for(i = 0; i < NUM_SETS; i++)
+    // Build the Miss-Ratio Curve Instead of Simulating the Trace's Geometry
+    if(OPTIONS.curveSets)
     {
-        printf("Set %d: ", i);
-        int j;
-        for(j = 0; j < SET_ASSOCIATIVITY; j++)
+        StackDistance* engines[32];
+        int count = 0;
+        unsigned int sets;
+        for(sets = 1; sets <= OPTIONS.curveSets; sets *= 2)
         {
-            printf("%d[%d] ", CACHE->sets[i].blocks[j].address, CACHE->sets[i].blocks[j].lastused);
+            engines[count] = initStackDistance(count, OPTIONS.curveWays);
+            count++;
         }
-        printf("\n");
+
+        unsigned long references = simulateStackDistance(reader, engines, count);
+        printMissRatioCurve(engines, count, references);
+
+        closeTraceReader(reader);
+        int i;
+        for(i = 0; i < count; i++)
+            deinitStackDistance(engines[i]);
+        return 0;
     }
-}
 
-void printTranslatedLines(void)
-{
+    // Estimate From Samples of the Blocks, Each on Caches Scaled Down by the Sampling Rate
+    int count = strlen(OPTIONS.policies);
     int i;
-    for(i = 0; i < LINE_LIST->size; i++)
+    if(OPTIONS.sampleShift)
     {
-        printf("%c %d %d %d %d\n", LINE_LIST->lines[i].operation, LINE_LIST->lines[i].address, getTagBits(LINE_LIST->lines[i].address), getIndexBits(LINE_LIST->lines[i].address), getOffsetBits(LINE_LIST->lines[i].address));
-    }
-}
+        if(OPTIONS.sampleShift > GEOMETRY.indexBits)
+        {
+            fprintf(stderr, "Sampling rate is below 1/%u, one block per set\n", GEOMETRY.numSets);
+            closeTraceReader(reader);
+            return 1;
+        }
 
-void printInput(void)
-{
-    printf("Block Size: %d\nNumber of Sets: %d\nSet Associativity: %d\nLines: %d\n", BLOCK_SIZE, NUM_SETS, SET_ASSOCIATIVITY, LINE_LIST->size);
-    printLines();
-}
+        Geometry scaled = scaleGeometry(&GEOMETRY, OPTIONS.sampleShift);
+        Cache* samples[MAX_SEEDS * MAX_POLICIES];
+        for(i = 0; i < (int)OPTIONS.seeds * count; i++)
+            samples[i] = initCache(&scaled, findWritePolicy(OPTIONS.policies[i % count]), OPTIONS.replacement);
 
-double logBase(int num, int base)
-{
-    return (log(num)/log(base));
-}
+        unsigned long references = simulateSampled(reader, samples, count, OPTIONS.seeds, OPTIONS.sampleShift);
+        printSampledReport(samples, count, OPTIONS.seeds, OPTIONS.sampleShift, references);
 
-/*----------------------------------*
- *                MAIN              *
- *----------------------------------*/
-int main()
-{
-    // Initialize Dynamic Lines
-    initLines();
+        closeTraceReader(reader);
+        for(i = 0; i < (int)OPTIONS.seeds * count; i++)
+            deinitCache(samples[i]);
+        return 0;
+    }
 
-    // Parse Input
-    parseInput();
+    // Create a Cache for Each Write Policy (Write-Through, No-Write-Allocate and
+    // Write-Back, Write-Allocate by Default)
+    Cache* caches[MAX_POLICIES];
+    for(i = 0; i < count; i++)
+    {
+        caches[i] = initCache(&GEOMETRY, findWritePolicy(OPTIONS.policies[i]), OPTIONS.replacement);
+        if(OPTIONS.prefetcher)
+            setPrefetcher(caches[i], OPTIONS.prefetcher);
+        if(OPTIONS.victimKind)
+            setVictimCache(caches[i], OPTIONS.victimKind, OPTIONS.victimEntries);
+        if(OPTIONS.classify)
+            setClassifier(caches[i]);
+        if(OPTIONS.dram.banks)
+            setDram(caches[i], &OPTIONS.dram);
+    }
 
-    // Create Cache
-    initCache();
+    // Log Every Cache's Counters to One CSV, Ahead of the Reports When Written to Stdout (Attached
+    // Before the Restore, Which Starts the First Interval From the Restored Counters)
+    FILE* intervalFile = stdout;
+    if(OPTIONS.interval)
+    {
+        if(OPTIONS.intervalPath && !(intervalFile = fopen(OPTIONS.intervalPath, "w")))
+        {
+            fprintf(stderr, "Could not open %s\n", OPTIONS.intervalPath);
+            closeTraceReader(reader);
+            for(i = 0; i < count; i++)
+                deinitCache(caches[i]);
+            return 1;
+        }
+        fprintf(intervalFile, "Policy,Interval,References,Misses,Miss Ratio,Writebacks,Memory References,Unique Blocks\n");
+        for(i = 0; i < count; i++)
+            setIntervalLog(caches[i], OPTIONS.interval, OPTIONS.warmup, intervalFile);
+    }
 
-    // Calculate & Print Common/Shared Cache Information
-    calculateAddressBits();
-    printHeader();
+    // Start From a Warmed Checkpoint Instead of Cold Caches
+    if(OPTIONS.restorePath)
+    {
+        if(!restoreCheckpoint(caches, count, OPTIONS.restorePath))
+        {
+            closeTraceReader(reader);
+            for(i = 0; i < count; i++)
+                deinitCache(caches[i]);
+            if(intervalFile != stdout)
+                fclose(intervalFile);
+            return 1;
+        }
+        if(OPTIONS.clearRestored)
+        {
+            for(i = 0; i < count; i++)
+                clearCounters(caches[i]);
+        }
+    }
 
-    // Execute Write-Through, No-Write-Allocate Caching Patterns
-    simulate('T');
+    // Execute Every Policy's Caching Pattern in One Pass, Feeding Lines Straight From the Trace
+    // (Prefetches, Victim Caches, the Fully Associative Shadow and Skewed Ways Cross Sets, so Those Caches are Not
+    // Sharded, and Intervals and the DRAM Take the References in Trace Order)
+    if(OPTIONS.threads > 1 && !OPTIONS.prefetcher && !OPTIONS.victimKind && !OPTIONS.classify && !OPTIONS.interval &&
+       GEOMETRY.indexing != 's' && !OPTIONS.dram.banks)
+        simulateSharded(reader, caches, count, OPTIONS.threads);
+    else
+        simulatePipelined(reader, caches, count, OPTIONS.collapseRuns);
 
-    // Print Write-Through, No-Write-Allocate Cache Report
-    printCacheReport('T');
+    if(OPTIONS.dram.banks)
+    {
+        for(i = 0; i < count; i++)
+            drainDram(caches[i]->dram);
+    }
+    if(OPTIONS.interval)
+    {
+        for(i = 0; i < count; i++)
+            flushIntervalLog(caches[i]);
+        if(intervalFile != stdout)
+            fclose(intervalFile);
+    }
 
-    // Reset for Next Strategy
-    resetCache();
-    
-    // Execute Write-Back, Write-Allocate Caching Patterns
-    simulate('B');
+    // Save the Warmed Caches Before Reporting
+    if(OPTIONS.savePath && !saveCheckpoint(caches, count, OPTIONS.savePath))
+    {
+        closeTraceReader(reader);
+        for(i = 0; i < count; i++)
+            deinitCache(caches[i]);
+        return 1;
+    }
 
-    // Print Write-Back, Write-Allocate Cache Report
-    printCacheReport('B');
+    // Print Each Policy's Cache Report
+    for(i = 0; i < count; i++)
+    {
+        printCacheReport(caches[i]);
+        if(OPTIONS.timingCount)
+            printTimingReport(caches[i], &OPTIONS.timings[0], OPTIONS.bandwidth);
+    }
 
     // Deinitialize
-    deinitLines();
-    deinitCache();
+    closeTraceReader(reader);
+    for(i = 0; i < count; i++)
+        deinitCache(caches[i]);
 }
+#endif
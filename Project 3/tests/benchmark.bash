@@ -0,0 +1,35 @@
+#!/bin/bash
+# ABOUT:       Benchmark the simulator's throughput on generated workloads across geometries, write policies,
+#              and replacement policies. Results are compared against the baselines in tests/baselines, and any
+#              configuration more than 10% slower is flagged. Baselines missing for a workload are recorded.
+#              Pass --record to store every result as the new baseline instead of comparing.
+# ASSUMPTIONS: Executed from the Project 3 directory, on a machine otherwise idle while it runs.
+record=0
+[ "$1" = "--record" ] && record=1
+gcc -O2 -pthread proj3_sweatt.c -lm -o proj3 || exit 1
+mkdir -p tests/baselines
+traces=$(mktemp -d)
+trap 'rm -rf "$traces"' EXIT
+
+status=0
+for workload in seq:4000000:8M stride=256:4000000:8M random:4000000:8M zipf=0.99:4000000:16M chase:4000000:4M:0 mix:4000000:16M
+do
+    name=${workload%%[=:]*}
+    ./proj3 -g $workload | ./proj3 -c "$traces/$name.bin" || exit 1
+    for replacement in lru srrip
+    do
+        baseline=tests/baselines/${name}_$replacement.csv
+        echo "---------- $workload with $replacement ----------"
+        if [ $record = 1 ] || [ ! -f "$baseline" ]
+        then
+            ./proj3 -B 64:64,1024:1-16 -w TB -r $replacement "$traces/$name.bin" > "$baseline" || exit 1
+            echo "Recorded $baseline"
+        elif ! ./proj3 -B 64:64,1024:1-16 -w TB -r $replacement -e "$baseline" "$traces/$name.bin" | grep REGRESSION
+        then
+            echo "No regressions"
+        else
+            status=1
+        fi
+    done
+done
+exit $status